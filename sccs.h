@@ -0,0 +1,805 @@
+/*
+ * sccs.h -- connected components of undirected graphs, header-only library
+ * 	used by the programs in this repository, can be used directly from
+ * 	C++ code as well
+ *
+ * main interface is the ConnectedComponents class, example usage:
+
+std::vector<uint32_t> u, v; // edges between u[i] and v[i]
+...
+ConnectedComponents<uint32_t> cc;
+cc.add_edges(u.data(),v.data(),u.size()); // note: edges are not copied
+if(!cc.compute()) ... // handle error
+uint32_t c = cc.component_of(u[0]); // smallest node ID in the component
+cc.for_each_component([](uint32_t c, const std::vector<uint32_t>& nodes) { ... });
+
+ * available algorithms (engines):
+ *   -- union-find (default): fast, memory use depends only on the number of nodes
+ *   -- iterative: the original algorithm of sccs32s, needs to copy the
+ *     edges, but can use a temporary file for this to reduce memory use
+ * both label every node with the smallest node ID in its component
+ *
+ * Copyright 2016,2018 Kondor Dániel <dkondor@mit.edu>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _SCCS_H
+#define _SCCS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <vector>
+#include <unordered_map> // needs c++11
+#include <utility>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* use POSIX functions for memory management */
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/*
+ * compute non-trivial hash of a 32-bit unsigned integer
+ *
+ * main motivation: the integer hash functions provided by STL with g++
+ * are a no-op, which can cause problems if the node IDs do not have good
+ * randomness in the low bits
+ *
+ * this is the case e.g. for Twitter tweet IDs, which results in a huge
+ * amount of hash collisions
+ */
+struct ch32 {
+	/* taken from
+	 * https://stackoverflow.com/questions/664014/what-integer-hash-function-are-good-that-accepts-an-integer-hash-key
+	 */
+	size_t operator()(uint32_t x_) const {
+		size_t x = x_;
+		x = ((x >> 16) ^ x) * 0x45d9f3b;
+	    x = ((x >> 16) ^ x) * 0x45d9f3b;
+	    x = (x >> 16) ^ x;
+	    return x;
+	}
+};
+
+/* hash of 64-bit unsigned integers (finalizer of splitmix64) */
+struct ch64 {
+	size_t operator()(uint64_t x) const {
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9UL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebUL;
+		return x ^ (x >> 31);
+	}
+};
+
+/* default hash to use for node IDs */
+template<class IdT> struct sccs_hash { };
+template<> struct sccs_hash<uint32_t> { typedef ch32 type; };
+template<> struct sccs_hash<uint64_t> { typedef ch64 type; };
+
+
+/*
+ * union-find (disjoint set) structure over sparse node IDs, stored in a
+ * hash map (node ID -> parent)
+ *
+ * the root of each set is always its smallest member, so the labels
+ * given by find() are the same as the result of the iterative algorithm
+ * in sccs32s.cpp (every node is assigned the smallest node ID in its
+ * component); no union by rank is done because of this, path halving in
+ * find() keeps the trees shallow enough in practice
+ */
+template<class IdT = uint32_t, class Hash = typename sccs_hash<IdT>::type>
+struct union_find {
+	std::unordered_map<IdT,IdT,Hash> parent;
+
+	/* add a node as a singleton set (does nothing if it already exists) */
+	void add(IdT x) { parent.insert(std::make_pair(x,x)); }
+	/* check if a node has been added */
+	bool contains(IdT x) const { return parent.count(x) > 0; }
+	/* number of nodes added so far */
+	size_t size() const { return parent.size(); }
+
+	/* find the root (i.e. the component label) of x
+	 * note: nodes that were not added are treated as singletons */
+	IdT find(IdT x) {
+		auto it = parent.find(x);
+		if(it == parent.end()) return x;
+		while(it->second != x) {
+			auto it2 = parent.find(it->second);
+			it->second = it2->second; /* path halving */
+			x = it2->second;
+			it = parent.find(x);
+		}
+		return x;
+	}
+	/* same without path halving, so that it can be used from multiple
+	 * threads at the same time (as long as no nodes are added) */
+	IdT root(IdT x) const {
+		auto it = parent.find(x);
+		if(it == parent.end()) return x;
+		while(it->second != x) {
+			x = it->second;
+			it = parent.find(x);
+		}
+		return x;
+	}
+
+	/* add an edge between a and b (adding the nodes if needed)
+	 * returns true if this merged two previously separate components */
+	bool unite(IdT a, IdT b) {
+		IdT absorbed, surviving;
+		return unite(a,b,absorbed,surviving);
+	}
+	/* same, but also give the components that were merged: absorbed is
+	 * the ID of the component that was merged into surviving */
+	bool unite(IdT a, IdT b, IdT& absorbed, IdT& surviving) {
+		add(a);
+		add(b);
+		IdT r1 = find(a);
+		IdT r2 = find(b);
+		if(r1 == r2) return false;
+		if(r2 < r1) std::swap(r1,r2);
+		parent[r2] = r1;
+		absorbed = r2;
+		surviving = r1;
+		return true;
+	}
+};
+
+
+/*
+ * simple hash map with open addressing (linear probing) storing keys and
+ * values in one flat array -- uses much less memory and has better
+ * locality than std::unordered_map, but elements cannot be removed
+ * the largest possible key value is used to mark empty slots, it is
+ * stored separately if used as a key
+ */
+template<class IdT = uint32_t, class ValT = IdT, class Hash = typename sccs_hash<IdT>::type>
+class flat_map {
+	protected:
+		static constexpr IdT empty_key = ~(IdT)0;
+		std::vector<std::pair<IdT,ValT> > t;
+		size_t mask;
+		size_t n;
+		bool has_empty; /* empty_key was added as a key */
+		ValT empty_val;
+		Hash h;
+
+		void rehash(size_t size) {
+			std::vector<std::pair<IdT,ValT> > t2(size,std::make_pair(empty_key,ValT()));
+			mask = size - 1;
+			for(const auto& x : t) if(x.first != empty_key) {
+				size_t i = h(x.first) & mask;
+				while(t2[i].first != empty_key) i = (i + 1) & mask;
+				t2[i] = x;
+			}
+			t.swap(t2);
+		}
+
+	public:
+		flat_map() : mask(0),n(0),has_empty(false),empty_val() { }
+		explicit flat_map(size_t expected) : flat_map() { reserve(expected); }
+
+		/* make space for at least size elements (keeping the load below 0.5) */
+		void reserve(size_t size) {
+			size_t s = 16;
+			while(s < 2*size) s *= 2;
+			if(s > t.size()) rehash(s);
+		}
+		size_t size() const { return n; }
+
+		/* find the value stored for key k, return null if not found */
+		ValT* find(IdT k) {
+			if(k == empty_key) return has_empty ? &empty_val : 0;
+			if(t.empty()) return 0;
+			for(size_t i = h(k) & mask;;i = (i + 1) & mask) {
+				if(t[i].first == k) return &(t[i].second);
+				if(t[i].first == empty_key) return 0;
+			}
+		}
+		const ValT* find(IdT k) const { return const_cast<flat_map*>(this)->find(k); }
+
+		/* insert (k,v) if k is not in the map yet; returns a pointer to
+		 * the value stored for k and true if it was inserted now */
+		std::pair<ValT*,bool> insert(IdT k, const ValT& v) {
+			if(k == empty_key) {
+				bool ins = !has_empty;
+				if(ins) { has_empty = true; empty_val = v; n++; }
+				return std::make_pair(&empty_val,ins);
+			}
+			if(2*(n+1) > t.size()) rehash(t.empty() ? 16 : 2*t.size());
+			size_t i = h(k) & mask;
+			for(;t[i].first != empty_key;i = (i + 1) & mask)
+				if(t[i].first == k) return std::make_pair(&(t[i].second),false);
+			t[i] = std::make_pair(k,v);
+			n++;
+			return std::make_pair(&(t[i].second),true);
+		}
+
+		/* call f(key,value) for all elements */
+		template<class F> void for_each(F&& f) const {
+			for(const auto& x : t) if(x.first != empty_key) f(x.first,x.second);
+			if(has_empty) f(empty_key,empty_val);
+		}
+
+		void clear() {
+			t.clear();
+			mask = 0;
+			n = 0;
+			has_empty = false;
+		}
+};
+
+
+/* edge with a key used for ordering (e.g. time or weight) */
+template<class KeyT, class IdT = uint32_t>
+struct sccs_keyed_edge {
+	KeyT key;
+	IdT u;
+	IdT v;
+};
+
+/* process edges in order with union-find, providing the components at
+ * a list of cutoffs and the merges of components:
+ *   -- edges should be sorted according to before (e.g. std::less for
+ *     increasing time, std::greater for decreasing weight) and cutoffs
+ *     should be sorted in the same order
+ *   -- at each cutoff c, all edges with keys not after c (i.e. for which
+ *     before(c,key) is false) are processed, then snap(c) is called
+ *     (uf contains the components at this point)
+ *   -- ev(key,absorbed,surviving) is called for each merge of components;
+ *     also, ev(key,x,x) is called when a node x first appears in a self-loop
+ *     (the only case when a new node is not part of a merge), so that
+ *     processing the events with uf.unite() gives back all nodes
+ *   -- if all == true, remaining edges after the last cutoff are also
+ *     processed (to give all merge events) */
+template<class KeyT, class IdT, class Hash, class Before, class Ev, class Snap>
+void sccs_ordered(const sccs_keyed_edge<KeyT,IdT>* e, uint64_t n, const KeyT* cutoffs,
+		size_t ncutoffs, bool all, Before before, union_find<IdT,Hash>& uf, Ev&& ev, Snap&& snap) {
+	uint64_t i = 0;
+	IdT absorbed, surviving;
+	auto step = [&uf,&ev,&absorbed,&surviving](const sccs_keyed_edge<KeyT,IdT>& x) {
+		if(x.u == x.v) {
+			if(!uf.contains(x.u)) {
+				uf.add(x.u);
+				ev(x.key,x.u,x.u);
+			}
+		}
+		else if(uf.unite(x.u,x.v,absorbed,surviving)) ev(x.key,absorbed,surviving);
+	};
+	for(size_t j=0;j<ncutoffs;j++) {
+		for(;i<n && !before(cutoffs[j],e[i].key);i++) step(e[i]);
+		snap(cutoffs[j]);
+	}
+	if(all) for(;i<n;i++) step(e[i]);
+}
+
+
+/* buffer for storing edges: either anonymous memory or a temporary file
+ * (that is deleted immediately, so the space is freed at exit) mapped to
+ * memory; using a temporary file means the OS can swap out parts of it
+ * if there is not enough memory */
+struct sccs_buffer {
+	void* buf;
+	size_t s;
+	int f;
+	sccs_buffer() : buf(MAP_FAILED),s(0),f(-1) { }
+	~sccs_buffer() { release(); }
+	sccs_buffer(const sccs_buffer&) = delete;
+	sccs_buffer& operator = (const sccs_buffer&) = delete;
+
+	/* allocate s_ bytes, using the file name tmpfn if given
+	 * returns 0 on success or an error code (same as the return value
+	 * of sccs32s in this case) */
+	int alloc(size_t s_, const char* tmpfn = 0) {
+		release();
+		s = s_;
+		if(tmpfn) {
+			/* note: O_EXCL makes sure the file does not already exist */
+			f = open(tmpfn,O_CREAT | O_RDWR | O_EXCL,S_IRUSR | S_IWUSR);
+			if(f == -1) {
+				fprintf(stderr,"Error opening temporary file %s!\n",tmpfn);
+				return 2;
+			}
+			if(ftruncate(f,s) == -1) {
+				fprintf(stderr,"Error setting file size on temporary file %s to %lu!\n",tmpfn,s);
+				close(f);
+				f = -1;
+				unlink(tmpfn);
+				return 3;
+			}
+			buf = mmap(0,s,PROT_READ | PROT_WRITE,MAP_SHARED,f,0);
+			unlink(tmpfn); /* note: do not keep the temporary file
+				-- might be confusing for some people that it's still taking up disk space? */
+			if(buf == MAP_FAILED) {
+				fprintf(stderr,"Error creating buffers from file %s!\n",tmpfn);
+				close(f);
+				f = -1;
+				return 4;
+			}
+		}
+		else {
+			/* just allocate a lot of memory */
+			buf = mmap(0,s,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+			if(buf == MAP_FAILED) {
+				fprintf(stderr,"Error allocating memory for the buffers!\n");
+				return 11;
+			}
+		}
+		return 0;
+	}
+	void release() {
+		if(buf != MAP_FAILED) munmap(buf,s);
+		if(f != -1) close(f);
+		buf = MAP_FAILED;
+		f = -1;
+		s = 0;
+	}
+};
+
+
+/* log of merges of components, written to a file in a binary format by a
+ * background thread (so that writing does not slow down processing)
+ * each record is four integers of the same type as node IDs, in native
+ * byte order: ID of the component merged (absorbed), ID of the component
+ * it was merged into (surviving), size of the surviving component before
+ * and after the merge
+ * sizes of components are tracked here (components not seen before have
+ * one node); these can be set before starting if needed
+ * note: using this requires linking with -pthread */
+template<class IdT = uint32_t, class Hash = typename sccs_hash<IdT>::type>
+class sccs_merge_log {
+	public:
+		struct record {
+			IdT absorbed;
+			IdT surviving;
+			IdT size_before;
+			IdT size_after;
+		};
+		/* size of components that have more than one node */
+		std::unordered_map<IdT,IdT,Hash> sizes;
+
+	protected:
+		FILE* f;
+		size_t bufsize;
+		/* records are added to cur; when it is full, it is swapped with
+		 * pending (waiting until the writer thread has finished with it) */
+		std::vector<record> cur;
+		std::vector<record> pending;
+		std::thread th;
+		std::mutex m;
+		std::condition_variable cv;
+		bool has_pending;
+		bool stop;
+		bool error;
+		uint64_t n;
+
+		void writer() {
+			std::unique_lock<std::mutex> lock(m);
+			while(true) {
+				cv.wait(lock,[this]() { return has_pending || stop; });
+				if(has_pending) {
+					lock.unlock();
+					if(fwrite(pending.data(),sizeof(record),pending.size(),f) != pending.size()) error = true;
+					pending.clear();
+					lock.lock();
+					has_pending = false;
+					cv.notify_all();
+				}
+				else break;
+			}
+		}
+		void flush() {
+			std::unique_lock<std::mutex> lock(m);
+			cv.wait(lock,[this]() { return !has_pending; });
+			cur.swap(pending);
+			has_pending = true;
+			cv.notify_all();
+		}
+
+	public:
+		sccs_merge_log() : f(0),bufsize(0),has_pending(false),stop(false),error(false),n(0) { }
+		~sccs_merge_log() { close(); }
+		sccs_merge_log(const sccs_merge_log&) = delete;
+		sccs_merge_log& operator = (const sccs_merge_log&) = delete;
+
+		/* open the output file and start the writer thread; bufsize is
+		 * the number of records to write at once
+		 * returns true on success */
+		bool open(const char* fn, size_t bufsize_ = 1UL << 16) {
+			close();
+			f = fopen(fn,"w");
+			if(!f) return false;
+			bufsize = bufsize_ ? bufsize_ : 1;
+			cur.reserve(bufsize);
+			pending.reserve(bufsize);
+			has_pending = false;
+			stop = false;
+			error = false;
+			n = 0;
+			th = std::thread(&sccs_merge_log::writer,this);
+			return true;
+		}
+
+		/* record that absorbed was merged into surviving (these should be
+		 * the IDs of the components before the merge) */
+		void merge(IdT absorbed, IdT surviving) {
+			IdT s1 = 1, s2 = 1;
+			auto it = sizes.find(absorbed);
+			if(it != sizes.end()) { s1 = it->second; sizes.erase(it); }
+			it = sizes.find(surviving);
+			if(it != sizes.end()) s2 = it->second;
+			sizes[surviving] = s1 + s2;
+			cur.push_back(record{absorbed,surviving,s2,(IdT)(s1 + s2)});
+			n++;
+			if(cur.size() >= bufsize) flush();
+		}
+
+		/* number of merges recorded so far */
+		uint64_t size() const { return n; }
+
+		/* write all remaining records and close the file
+		 * returns false if there was any error writing the output */
+		bool close() {
+			if(!f) return true;
+			if(cur.size()) flush();
+			{
+				std::unique_lock<std::mutex> lock(m);
+				cv.wait(lock,[this]() { return !has_pending; });
+				stop = true;
+				cv.notify_all();
+			}
+			th.join();
+			if(fclose(f)) error = true;
+			f = 0;
+			return !error;
+		}
+};
+
+
+/* calculate connected components with the iterative algorithm
+ * edges are given in u1 and u2 (n in total); note that these are modified
+ * (edges already inside one component are removed during processing)
+ * the result is stored in sccs (key is node ID, value is the component ID,
+ * which is the smallest node ID in the component)
+ * progress is written to log (if not null), merges of components to
+ * mlog (if not null)
+ * returns the number of iterations done, or -1 on error */
+template<class IdT, class Hash>
+int sccs_iterative(IdT* u1, IdT* u2, uint64_t n,
+		std::unordered_map<IdT,IdT,Hash>& sccs, bool use_reverse_map, FILE* log = 0,
+		sccs_merge_log<IdT,Hash>* mlog = 0) {
+	time_t t1;
+	std::unordered_map<IdT,IdT,Hash> merge; //keep track of sccs to merge
+	/* optional extra copy of assignement of users to sccs
+	 *  -- key is sccid, stored value is userid
+	 * used to be able to update sccs more efficiently */
+	std::unordered_multimap<IdT,IdT,Hash> sccs2;
+	
+	//1. just get all users
+	for(uint64_t i=0;i<n;i++) {
+		/* note: at first each user is in a separate scc, so the sccs
+		 * multimap can be used to find all unique userids */
+		auto it = sccs.find(u1[i]);
+		if(it == sccs.end()) sccs.insert(std::make_pair(u1[i],u1[i]));
+		it = sccs.find(u2[i]);
+		if(it == sccs.end()) sccs.insert(std::make_pair(u2[i],u2[i]));
+	}
+	
+	if(log) {
+		t1 = time(0);
+		fprintf(log,"%s%lu users in total\n",ctime(&t1),sccs.size());
+	}
+	
+	//2. iteratively update sccs assignements, always try to lower scc ids
+	int j = 0;
+	uint64_t k = 0;
+	while(1) {
+		for(uint64_t i=0;i<n;i++) {
+			IdT i1 = sccs[u1[i]];
+			IdT i2 = sccs[u2[i]];
+			
+			while(i2 == i1 && i<n) {
+				/* remove edges where both addresses already were assigned to
+				 * the same scc -- these will not affect the result anymore */
+				u1[i] = u1[n-1];
+				u2[i] = u2[n-1];
+				i1 = sccs[u1[i]];
+				i2 = sccs[u2[i]];
+				n--;
+			}
+			if(i == n) break; /* no more edges to process */
+			if(i2 < i1) {
+				IdT tmp = i2;
+				i2 = i1;
+				i1 = tmp;
+			}
+			
+			// add to the list of merges
+			auto it = merge.find(i2);
+			if(it == merge.end()) merge.insert(std::make_pair(i2,i1));
+			else if(i1 < it->second) it->second = i1;
+		}
+		
+		if(merge.size() == 0) break; //no more updates to do
+		
+		/* go through all updates to do, find the minimum for each SCC edge */
+		{
+			std::vector<typename std::unordered_map<IdT,IdT,Hash>::iterator> updates;
+			for(auto it = merge.begin();it!=merge.end();++it) {
+				auto it1 = it;
+				auto it2 = merge.find(it1->second);
+				while(it2 != merge.end()) {
+					updates.push_back(std::move(it1));
+					it1 = it2;
+					it2 = merge.find(it1->second);
+				}
+				IdT idlast = it1->second;
+				while(!updates.empty()) {
+					updates.back()->second = idlast;
+					updates.pop_back();
+				}
+			}
+		}
+		/* each entry in merge is now a component merged into a remaining one */
+		if(mlog) for(const auto& x : merge) mlog->merge(x.first,x.second);
+		
+		/* do the updates; simple version which iterates over all users,
+		 * this could be improved by sorting them by sccid */
+		if(sccs2.size() == 0) for(auto it = sccs.begin(); it != sccs.end(); ++it) {
+			IdT sccid = it->second;
+			auto it2 = merge.find(sccid);
+			if(it2 != merge.end()) { it->second = it2->second; k++; }
+			/* create the reverse map during the first pass */
+			if(use_reverse_map) sccs2.insert(std::make_pair(it->second,it->first));
+		}
+		/* improved version: scc ids can be searched in the sccs multimap */
+		else for(const auto& sccedge : merge) {
+			/* replace sccedge.first with sccedge.second everywhere */
+			/* note: use C++17 style node access and modification -- does not work until gcc 7.1
+			auto x = sccs2.extract(sccedge.first);
+			if(x.empty()) {
+				fprintf(stderr,"Inconsistent scc mappings: scc %u has no users in it!\n",sccedge.first);
+				k = 0;
+				break;
+			}
+			do {
+				x.key = sccedge.second;
+				sccs[x.value] = sccedge.second;
+				sccs2.insert(x);
+				k++;
+				x = sccs2.extract(sccedge.first);
+			} while(!x.empty()); */
+			auto it = sccs2.find(sccedge.first);
+			if(it == sccs2.end()) {
+				if(log) fprintf(log,"Inconsistent scc mappings: scc %lu has no users in it!\n",(uint64_t)sccedge.first);
+				k = 0;
+				break;
+			}
+			do {
+				std::pair<IdT,IdT> x = *it; /* note: this creates a copy */
+				sccs2.erase(it);
+				x.first = sccedge.second;
+				sccs[x.second] = sccedge.second;
+				sccs2.insert(x);
+				k++;
+				it = sccs2.find(sccedge.first);
+			} while(it != sccs2.end());
+		}
+		if(k == 0) { j = -1; break; } /* error occured previously */
+		
+		j++;
+		if(log) {
+			t1 = time(0);
+			fprintf(log,"%siteration %d, %lu edges remain, %lu sccs / %lu users updated\n",ctime(&t1),j,n,merge.size(),k);
+		}
+		merge.clear();
+		k = 0;
+	}
+	
+	return j;
+}
+
+
+/* calculate connected components with a union-find structure, for
+ * edges given by gen: gen(f) should call f(u,v) for each edge (an edge
+ * with u == v only adds the node); the result is stored in sccs (same
+ * as for sccs_iterative()); this is used by all of the following */
+template<class IdT, class Hash, class Gen>
+void sccs_union_find_gen(Gen&& gen, std::unordered_map<IdT,IdT,Hash>& sccs,
+		FILE* log = 0, sccs_merge_log<IdT,Hash>* mlog = 0) {
+	union_find<IdT,Hash> uf;
+	if(mlog) {
+		IdT absorbed, surviving;
+		gen([&uf,mlog,&absorbed,&surviving](IdT x, IdT y) {
+			if(uf.unite(x,y,absorbed,surviving)) mlog->merge(absorbed,surviving);
+		});
+	}
+	else gen([&uf](IdT x, IdT y) { uf.unite(x,y); });
+	if(log) {
+		time_t t1 = time(0);
+		fprintf(log,"%s%lu users in total\n",ctime(&t1),uf.size());
+	}
+	sccs.reserve(sccs.size() + uf.size());
+	for(const auto& x : uf.parent) sccs[x.first] = uf.find(x.first);
+}
+
+/* calculate connected components with a union-find structure
+ * edges are given in u1 and u2 (n in total), they are not modified
+ * the result is stored in sccs (same as for sccs_iterative()) */
+template<class IdT, class Hash>
+void sccs_union_find(const IdT* u1, const IdT* u2, uint64_t n,
+		std::unordered_map<IdT,IdT,Hash>& sccs, FILE* log = 0,
+		sccs_merge_log<IdT,Hash>* mlog = 0) {
+	sccs_union_find_gen([u1,u2,n](auto&& f) {
+			for(uint64_t i=0;i<n;i++) f(u1[i],u2[i]);
+		},sccs,log,mlog);
+}
+
+/* same, but for hyperedges stored in CSR format: hyperedge i consists of
+ * the nodes members[offsets[i]] ... members[offsets[i+1]-1] (n hyperedges,
+ * offsets has n+1 elements), all of which are in the same component (a
+ * hyperedge with one node only adds that node) */
+template<class IdT, class Hash>
+void sccs_union_find_csr(const uint64_t* offsets, const IdT* members, uint64_t n,
+		std::unordered_map<IdT,IdT,Hash>& sccs, FILE* log = 0,
+		sccs_merge_log<IdT,Hash>* mlog = 0) {
+	sccs_union_find_gen([offsets,members,n](auto&& f) {
+			for(uint64_t i=0;i<n;i++) {
+				IdT x = members[offsets[i]];
+				if(offsets[i] + 1 == offsets[i+1]) f(x,x);
+				for(uint64_t j=offsets[i]+1;j<offsets[i+1];j++) f(x,members[j]);
+			}
+		},sccs,log,mlog);
+}
+
+
+/* options for ConnectedComponents::compute() */
+enum class sccs_engine { union_find, iterative };
+struct sccs_options {
+	sccs_engine engine;
+	const char* tmpfn; /* iterative engine: temporary file to store the edges */
+	bool use_reverse_map; /* iterative engine: keep a reverse map to update components */
+	FILE* log; /* write progress messages to this file */
+	sccs_options() : engine(sccs_engine::union_find),tmpfn(0),use_reverse_map(false),log(0) { }
+};
+
+/* main interface: add edges (any number of times), then call compute() */
+template<class IdT = uint32_t, class Hash = typename sccs_hash<IdT>::type>
+class ConnectedComponents {
+	protected:
+		/* edges added, stored as pointers to the caller's arrays
+		 * (either two separate arrays or one array of pairs) */
+		struct edge_span {
+			const IdT* u;
+			const IdT* v;
+			const std::pair<IdT,IdT>* e;
+			size_t n;
+		};
+		std::vector<edge_span> edges;
+		std::unordered_map<IdT,IdT,Hash> sccs;
+		size_t ncomps;
+
+		template<class F> void for_each_edge(F&& f) const {
+			for(const auto& s : edges) {
+				if(s.e) for(size_t i=0;i<s.n;i++) f(s.e[i].first,s.e[i].second);
+				else for(size_t i=0;i<s.n;i++) f(s.u[i],s.v[i]);
+			}
+		}
+
+	public:
+		ConnectedComponents() : ncomps(0) { }
+
+		/* add edges between u[i] and v[i], for 0 <= i < n
+		 * note: the edges are not copied, the arrays need to be valid
+		 * (and unchanged) until compute() is called */
+		void add_edges(const IdT* u, const IdT* v, size_t n) {
+			if(n) edges.push_back(edge_span{u,v,0,n});
+		}
+		/* add edges given as pairs of nodes (same note applies) */
+		void add_edges(const std::pair<IdT,IdT>* e, size_t n) {
+			if(n) edges.push_back(edge_span{0,0,e,n});
+		}
+		/* add edges from any container of pairs with contiguous storage */
+		template<class C> void add_edges(const C& c) { add_edges(c.data(),c.size()); }
+
+		/* calculate the components using all edges added so far
+		 * (previous results are discarded)
+		 * returns true on success */
+		bool compute(const sccs_options& opts = sccs_options()) {
+			sccs.clear();
+			ncomps = 0;
+			uint64_t n = 0;
+			for(const auto& s : edges) n += s.n;
+			if(opts.engine == sccs_engine::union_find)
+				sccs_union_find_gen([this](auto&& f) { for_each_edge(f); },sccs,opts.log);
+			else {
+				/* the iterative algorithm modifies the edges, so they are copied */
+				sccs_buffer buf;
+				if(n && buf.alloc(2*n*sizeof(IdT),opts.tmpfn)) return false;
+				IdT* u1 = (IdT*)buf.buf;
+				IdT* u2 = u1 + n;
+				uint64_t i = 0;
+				for_each_edge([u1,u2,&i](IdT x, IdT y) { u1[i] = x; u2[i] = y; i++; });
+				if(sccs_iterative(u1,u2,n,sccs,opts.use_reverse_map,opts.log) < 0) {
+					sccs.clear();
+					return false;
+				}
+			}
+			for(const auto& x : sccs) if(x.first == x.second) ncomps++;
+			return true;
+		}
+
+		/* component of node x (smallest node ID in it); nodes not in any
+		 * edge are in their own component */
+		IdT component_of(IdT x) const {
+			auto it = sccs.find(x);
+			return it == sccs.end() ? x : it->second;
+		}
+		/* check if node x was in any edge */
+		bool contains(IdT x) const { return sccs.count(x) > 0; }
+		/* number of nodes and components */
+		size_t size() const { return sccs.size(); }
+		size_t num_components() const { return ncomps; }
+		/* access to all nodes and their component */
+		const std::unordered_map<IdT,IdT,Hash>& labels() const { return sccs; }
+		typename std::unordered_map<IdT,IdT,Hash>::const_iterator begin() const { return sccs.begin(); }
+		typename std::unordered_map<IdT,IdT,Hash>::const_iterator end() const { return sccs.end(); }
+
+		/* call f(c,nodes) for each component c with the list of its nodes
+		 * (components are given in increasing order of IDs) */
+		template<class F> void for_each_component(F&& f) const {
+			std::vector<std::pair<IdT,IdT> > tmp;
+			tmp.reserve(sccs.size());
+			for(const auto& x : sccs) tmp.push_back(std::make_pair(x.second,x.first));
+			std::sort(tmp.begin(),tmp.end());
+			std::vector<IdT> nodes;
+			for(size_t i=0;i<tmp.size();) {
+				IdT c = tmp[i].first;
+				nodes.clear();
+				for(;i<tmp.size() && tmp[i].first == c;i++) nodes.push_back(tmp[i].second);
+				f(c,(const std::vector<IdT>&)nodes);
+			}
+		}
+
+		/* remove all edges and results */
+		void clear() {
+			edges.clear();
+			sccs.clear();
+			ncomps = 0;
+		}
+};
+
+#endif /* _SCCS_H */
+
@@ -0,0 +1,50 @@
+# sccs.py -- Python interface to the connected components library
+#
+# edges are given as two NumPy arrays of node IDs (u and v, edge i is
+# between u[i] and v[i]); arrays of type uint32 that are C-contiguous are
+# used without copying, anything else is converted first
+#
+# example:
+#   import numpy as np, sccs
+#   u = np.array([1, 2, 10], dtype=np.uint32)
+#   v = np.array([2, 3, 11], dtype=np.uint32)
+#   sccs.edge_labels(u, v)        # component of each edge: [1, 1, 10]
+#   sccs.node_labels(u, v, [3])   # component of the given nodes: [1]
+#   nodes, labels = sccs.components(u, v)  # all nodes (sorted) and their components
+#
+# components are labeled by the smallest node ID in them (same as sccs32s);
+# engine can be ENGINE_UNION_FIND (default) or ENGINE_ITERATIVE
+#
+# Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+# (see sccs_python.cpp for the license)
+
+import numpy as np
+import _sccs
+from _sccs import ENGINE_UNION_FIND, ENGINE_ITERATIVE
+
+
+def _as_uint32(a):
+    return np.ascontiguousarray(a, dtype=np.uint32)
+
+
+def edge_labels(u, v, engine=ENGINE_UNION_FIND):
+    u = _as_uint32(u)
+    v = _as_uint32(v)
+    out = np.empty(u.shape[0], dtype=np.uint32)
+    _sccs.edge_labels(u, v, out, engine)
+    return out
+
+
+def node_labels(u, v, nodes, engine=ENGINE_UNION_FIND):
+    u = _as_uint32(u)
+    v = _as_uint32(v)
+    nodes = _as_uint32(nodes)
+    out = np.empty(nodes.shape[0], dtype=np.uint32)
+    _sccs.node_labels(u, v, nodes, out, engine)
+    return out
+
+
+def components(u, v, engine=ENGINE_UNION_FIND):
+    nodes, labels = _sccs.components(_as_uint32(u), _as_uint32(v), engine)
+    return (np.frombuffer(nodes, dtype=np.uint32),
+            np.frombuffer(labels, dtype=np.uint32))
@@ -52,6 +52,9 @@
 #include <stdint.h>
 #include <vector>
 #include <unordered_map> // needs c++11
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
 #include <time.h>
 
 /* use POSIX functions for memory management */
@@ -62,43 +65,94 @@
 #include <sys/mman.h>
 
 #include "read_table.h"
+#include "sccs.h"
+#include "sccs_index.h"
 
 //~ using namespace std;
 
-/* 
- * compute non-trivial hash of a 32-bit unsigned integer
- * 
- * main motivation: the integer hash functions provided by STL with g++
- * are a no-op, which can cause problems if the node IDs do not have good
- * randomness in the low bits
- * 
- * this is the case e.g. for Twitter tweet IDs, which results in a huge
- * amount of hash collisions
- */
-struct ch32 {
-	/* taken from
-	 * https://stackoverflow.com/questions/664014/what-integer-hash-function-are-good-that-accepts-an-integer-hash-key
-	 */
-	size_t operator()(uint32_t x_) const {
-		size_t x = x_;
-		x = ((x >> 16) ^ x) * 0x45d9f3b;
-	    x = ((x >> 16) ^ x) * 0x45d9f3b;
-	    x = (x >> 16) ^ x;
-	    return x;
-	}
-};
+/* read the two node IDs of an edge (or a group and a member ID) from the
+ * current line, from columns c1 and c2 (zero-based, the default is the
+ * first two); other columns are skipped without parsing */
+template<class T1, class T2>
+static bool read_edge(read_table2& r, unsigned int c1, unsigned int c2, T1& x, T2& y) {
+	if(c1 == 0 && c2 == 1) return r.read(x,y);
+	if(c1 < c2) return r.read_skip(c1) && r.read(x) && r.read_skip(c2-c1-1) && r.read(y);
+	return r.read_skip(c2) && r.read(y) && r.read_skip(c1-c2-1) && r.read(x);
+}
 
 /* read graph (list of edges), maximum N edges */
-uint64_t read_graph(uint32_t* i1, uint32_t* i2, FILE* f, uint64_t N) {
-	read_table2 r(f);
+uint64_t read_graph(uint32_t* i1, uint32_t* i2, int fd, uint64_t N, unsigned int c1 = 0, unsigned int c2 = 1) {
+	read_table2 r(fd);
+	/* ignore overflow / negative values, but count them */
+	read_table_count_errors errs(READ_TABLE_ERROR_MASK(T_OVERFLOW));
+	uint64_t i = 0;
+	while(r.read_line()) {
+		if(i == N) {
+			fprintf(stderr,"Too many edges on the input!\n");
+			return 0;
+		}
+		if(!read_edge(r,c1,c2,i1[i],i2[i])) {
+			if(errs.error(r)) continue;
+			break;
+		}
+		i++;
+	}
+	errs.write_summary(stderr);
+	if(r.get_last_error() != T_EOF) {
+		r.write_error(stderr);
+		return 0;
+	}
+	return i;
+}
+
+/* read (group ID, member ID) pairs and create edges between the first
+ * member of each group and all other members (i.e. a star for each
+ * group, so that all members end up in the same component), calling
+ * f(u,v) for each edge, which should return false to stop reading; if
+ * contiguous is true, lines of the same group should be consecutive, and
+ * only the current group is kept track of; otherwise, the first member
+ * of each group is stored in a hash map
+ * note: duplicate lines are not filtered, these give duplicate edges
+ * the number of groups is stored in ngroups
+ * returns the number of edges, or 0 on error */
+template<class F>
+uint64_t read_groups_f(int fd, bool contiguous, uint64_t& ngroups, F&& f,
+		unsigned int c1 = 0, unsigned int c2 = 1) {
+	read_table2 r(fd);
+	read_table_count_errors errs(READ_TABLE_ERROR_MASK(T_OVERFLOW));
+	flat_map<uint64_t,uint32_t,ch64> first; /* first member of each group */
+	uint64_t g0 = 0; /* current group */
+	uint32_t m0 = 0; /* first member of the current group */
+	bool have_group = false;
 	uint64_t i = 0;
+	ngroups = 0;
 	while(r.read_line()) {
-		if(!r.read(i1[i],i2[i])) {
-			if(r.get_last_error() == T_OVERFLOW) continue; // ignore overflow / negative values
+		uint64_t g;
+		uint32_t m;
+		if(!read_edge(r,c1,c2,g,m)) {
+			if(errs.error(r)) continue; // ignore overflow / negative values
 			break;
 		}
+		if(!have_group || g != g0) {
+			g0 = g;
+			have_group = true;
+			if(contiguous) {
+				m0 = m;
+				ngroups++;
+				continue;
+			}
+			auto res = first.insert(g,m);
+			m0 = *res.first;
+			if(res.second) {
+				ngroups++;
+				continue;
+			}
+		}
+		if(m == m0) continue;
+		if(!f(m0,m)) return 0;
 		i++;
 	}
+	errs.write_summary(stderr);
 	if(r.get_last_error() != T_EOF) {
 		r.write_error(stderr);
 		return 0;
@@ -106,6 +160,277 @@ uint64_t read_graph(uint32_t* i1, uint32_t* i2, FILE* f, uint64_t N) {
 	return i;
 }
 
+/* same, storing the edges in i1 and i2, maximum N edges */
+uint64_t read_groups(uint32_t* i1, uint32_t* i2, int fd, uint64_t N, bool contiguous,
+		uint64_t& ngroups, unsigned int c1 = 0, unsigned int c2 = 1) {
+	uint64_t i = 0;
+	return read_groups_f(fd,contiguous,ngroups,[i1,i2,N,&i](uint32_t x, uint32_t y) {
+			if(i == N) {
+				fprintf(stderr,"Too many edges on the input!\n");
+				return false;
+			}
+			i1[i] = x;
+			i2[i] = y;
+			i++;
+			return true;
+		},c1,c2);
+}
+
+
+/* read hyperedges: each line contains any number of node IDs, which are
+ * stored in members (maximum N in total), while the start of each line
+ * is stored in offsets (in CSR format, i.e. offsets has one more element
+ * at the end); invalid (negative or too large) IDs are skipped
+ * returns the number of hyperedges, or 0 on error */
+uint64_t read_hyperedges(uint32_t* members, std::vector<uint64_t>& offsets, int fd, uint64_t N) {
+	read_table2 r(fd);
+	uint64_t m = 0; /* number of node IDs read */
+	uint64_t nskip = 0; /* number of invalid IDs */
+	offsets.clear();
+	while(r.read_line()) {
+		uint64_t m0 = m;
+		while(true) {
+			uint32_t x;
+			if(r.read_next(x)) {
+				if(m == N) {
+					fprintf(stderr,"Too many node IDs on the input!\n");
+					return 0;
+				}
+				members[m++] = x;
+			}
+			else if(r.get_last_error() == T_OVERFLOW) {
+				nskip++;
+				if(!r.read_skip()) break;
+			}
+			else break;
+		}
+		if(r.get_last_error() != T_EOL) break;
+		if(m > m0) offsets.push_back(m0);
+	}
+	if(nskip) fprintf(stderr,"%lu invalid node IDs skipped\n",nskip);
+	if(r.get_last_error() != T_EOF) {
+		r.write_error(stderr);
+		return 0;
+	}
+	offsets.push_back(m);
+	return offsets.size() - 1;
+}
+
+
+/* read a labeling of nodes (node ID -> component ID pairs) from the given
+ * file, calling f(node,label) for each pair; the file is either in the
+ * same text format as the output, or binary, i.e. pairs of 32-bit unsigned
+ * integers in native byte order (as written by the -s option)
+ * returns true on success */
+template<class F>
+bool read_labels(const char* fn, bool binary, F&& f) {
+	if(binary) {
+		int fd = open(fn,O_RDONLY);
+		if(fd == -1) {
+			fprintf(stderr,"Error opening file %s!\n",fn);
+			return false;
+		}
+		struct stat st;
+		if(fstat(fd,&st) == -1 || st.st_size % (2*sizeof(uint32_t))) {
+			fprintf(stderr,"Invalid size for binary file %s!\n",fn);
+			close(fd);
+			return false;
+		}
+		uint64_t n = st.st_size / (2*sizeof(uint32_t));
+		if(n) {
+			void* p = mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+			if(p == MAP_FAILED) {
+				fprintf(stderr,"Error mapping file %s!\n",fn);
+				close(fd);
+				return false;
+			}
+			madvise(p,st.st_size,MADV_SEQUENTIAL);
+			const uint32_t* x = (const uint32_t*)p;
+			for(uint64_t i=0;i<n;i++) f(x[2*i],x[2*i+1]);
+			munmap(p,st.st_size);
+		}
+		close(fd);
+	}
+	else {
+		read_table2 r(fn);
+		for(const auto& x : r.rows<uint32_t,uint32_t>()) f(std::get<0>(x),std::get<1>(x));
+		if(r.get_last_error() != T_EOF) {
+			r.write_error(stderr);
+			return false;
+		}
+	}
+	return true;
+}
+
+/* write one node ID -> component ID pair in the binary format used above */
+static inline void write_label_binary(FILE* f, uint32_t x, uint32_t l) {
+	uint32_t tmp[2] = {x,l};
+	fwrite(tmp,sizeof(uint32_t),2,f);
+}
+
+
+/* parse one key (timestamp) from a string, return a pointer after it */
+static inline const char* parse_key(const char* s, int64_t& k) {
+	char* end;
+	k = strtoll(s,&end,10);
+	return end;
+}
+
+static inline const char* parse_key(const char* s, double& k) {
+	char* end;
+	k = strtod(s,&end);
+	return end;
+}
+
+/* parse a list of cutoffs: either separated by commas, or if s starts
+ * with '@', read from the file given after it (one per line)
+ * returns true on success */
+template<class KeyT>
+bool read_cutoffs(const char* s, std::vector<KeyT>& c) {
+	if(s[0] == '@') {
+		read_table2 r(s+1);
+		for(const auto& x : r.rows<KeyT>()) c.push_back(std::get<0>(x));
+		if(r.get_last_error() != T_EOF) {
+			r.write_error(stderr);
+			return false;
+		}
+		return true;
+	}
+	while(*s) {
+		KeyT k;
+		const char* end = parse_key(s,k);
+		if(end == s || (*end && *end != ',')) {
+			fprintf(stderr,"Invalid list of cutoffs: %s!\n",s);
+			return false;
+		}
+		c.push_back(k);
+		s = *end ? end + 1 : end;
+	}
+	return true;
+}
+
+static inline void write_key(FILE* f, int64_t k) { fprintf(f,"%ld",k); }
+static inline void write_key(FILE* f, double k) { fprintf(f,"%.17g",k); }
+
+/* write the components in uf at the given cutoff */
+template<class KeyT>
+void write_snapshot(union_find<uint32_t,ch32>& uf, KeyT c) {
+	for(const auto& x : uf.parent) {
+		write_key(stdout,c);
+		fprintf(stdout,"\t%u\t%u\n",x.first,uf.find(x.first));
+	}
+	time_t t1 = time(0);
+	fprintf(stderr,"%scutoff ",ctime(&t1));
+	write_key(stderr,c);
+	fprintf(stderr,": %lu nodes\n",uf.size());
+}
+
+/* ordered mode: edges are read with a key (timestamp or weight) in the
+ * third column, processed in order (given by before) with union-find and either
+ * the full labeling is written for each cutoff (lines of cutoff, node ID,
+ * component ID) or all merges of components (lines of key, ID of the
+ * component merged and ID of the component it was merged into; this can
+ * be used to reconstruct the components at any cutoff: a node first
+ * appears when its component is merged with another)
+ * in the latter case, if cutoffs are given, only merges up to the last
+ * cutoff are written */
+template<class KeyT, class Before>
+int run_ordered(uint64_t n1, const char* tmpfn, std::vector<KeyT>& cutoffs, bool events, Before before) {
+	typedef sccs_keyed_edge<KeyT,uint32_t> edge;
+	if(!events && cutoffs.empty()) {
+		fprintf(stderr,"Error: no cutoffs given!\n");
+		return 1;
+	}
+	sccs_buffer buf;
+	int ret = buf.alloc(n1*sizeof(edge),tmpfn);
+	if(ret) return ret;
+	edge* e = (edge*)buf.buf;
+	
+	time_t t1 = time(0);
+	fprintf(stderr,"%sreading input\n",ctime(&t1));
+	uint64_t n = 0;
+	{
+		read_table2 r(STDIN_FILENO);
+		read_table_count_errors errs(READ_TABLE_ERROR_MASK(T_OVERFLOW));
+		while(r.read_line()) {
+			if(n == n1) {
+				fprintf(stderr,"Too many edges on the input!\n");
+				return 1;
+			}
+			if(!r.read(e[n].u,e[n].v,e[n].key)) {
+				if(errs.error(r)) continue; // ignore overflow / negative values
+				break;
+			}
+			n++;
+		}
+		errs.write_summary(stderr);
+		if(r.get_last_error() != T_EOF) {
+			r.write_error(stderr);
+			return 1;
+		}
+	}
+	t1 = time(0);
+	fprintf(stderr,"%s%lu edges read\n",ctime(&t1),n);
+	
+	/* sort edges, ties are ordered by node IDs so that the output is deterministic */
+	std::sort(e,e+n,[before](const edge& a, const edge& b) {
+		if(before(a.key,b.key)) return true;
+		if(before(b.key,a.key)) return false;
+		return a.u < b.u || (a.u == b.u && a.v < b.v);
+	});
+	std::sort(cutoffs.begin(),cutoffs.end(),before);
+	t1 = time(0);
+	fprintf(stderr,"%sedges sorted\n",ctime(&t1));
+	
+	union_find<uint32_t,ch32> uf;
+	uint64_t merges = 0;
+	if(events) sccs_ordered(e,n,cutoffs.data(),cutoffs.size(),cutoffs.empty(),before,uf,
+		[&merges](KeyT k, uint32_t absorbed, uint32_t surviving) {
+			write_key(stdout,k);
+			fprintf(stdout,"\t%u\t%u\n",absorbed,surviving);
+			if(absorbed != surviving) merges++;
+		}, [](KeyT) { });
+	else sccs_ordered(e,n,cutoffs.data(),cutoffs.size(),false,before,uf,
+		[&merges](KeyT, uint32_t absorbed, uint32_t surviving) { if(absorbed != surviving) merges++; },
+		[&uf](KeyT c) { write_snapshot(uf,c); });
+	
+	t1 = time(0);
+	fprintf(stderr,"%sdone processing, %lu merges, %lu nodes\n",ctime(&t1),merges,uf.size());
+	return 0;
+}
+
+
+/* extract the components at the given cutoffs from the merges written by
+ * run_ordered() with events == true (for the same ordering); lines with
+ * the same node twice (nodes first appearing in a self-loop) only add
+ * that node */
+template<class KeyT, class Before>
+int run_dendrogram(const char* fn, std::vector<KeyT>& cutoffs, Before before) {
+	if(cutoffs.empty()) {
+		fprintf(stderr,"Error: no cutoffs given!\n");
+		return 1;
+	}
+	std::vector<sccs_keyed_edge<KeyT,uint32_t> > e;
+	read_table2 r(fn);
+	while(r.read_line()) {
+		sccs_keyed_edge<KeyT,uint32_t> x;
+		if(!r.read(x.key,x.u,x.v)) break;
+		if(e.size() && before(x.key,e.back().key)) {
+			fprintf(stderr,"Merges in %s are not in the expected order (line %lu)!\n",fn,r.get_line());
+			return 1;
+		}
+		e.push_back(x);
+	}
+	if(r.get_last_error() != T_EOF) {
+		r.write_error(stderr);
+		return 1;
+	}
+	std::sort(cutoffs.begin(),cutoffs.end(),before);
+	union_find<uint32_t,ch32> uf;
+	sccs_ordered(e.data(),e.size(),cutoffs.data(),cutoffs.size(),false,before,uf,
+		[](KeyT, uint32_t, uint32_t) { }, [&uf](KeyT c) { write_snapshot(uf,c); });
+	return 0;
+}
 
 
 int main(int argc, char **argv)
@@ -113,6 +438,20 @@ int main(int argc, char **argv)
 	uint64_t n1 = 0;
 	char* tmpfn = 0;
 	bool use_reverse_map = false;
+	bool use_union_find = false;
+	char* prevfn = 0; /* previous result to update (incremental mode) */
+	bool prev_binary = false;
+	char* snapfn = 0; /* write binary snapshot of the full result to this file */
+	char* idxfn = 0; /* write index for lookups to this file */
+	bool time_mode = false; /* edges have a timestamp in the third column */
+	char* cutoffs = 0; /* list of cutoffs to output the components at */
+	bool events = false; /* output merge events instead of the components */
+	bool weighted = false; /* edges have a weight in the third column */
+	char* dendfn = 0; /* extract components from the merge events in this file */
+	char* mergefn = 0; /* write binary log of merges of components to this file */
+	unsigned int c1 = 0, c2 = 1; /* columns of the node IDs in the input (zero-based) */
+	int groups = 0; /* input is (group, member) pairs: 1: groups are contiguous, 2: any order */
+	bool hyper = false; /* each line is a hyperedge (any number of node IDs) */
 	
 	for(int i=1;i<argc;i++) if(argv[i][0] == '-') switch(argv[i][1]) {
 		case 'N': /* maximum number of edges in the graph, need to be given */
@@ -124,197 +463,282 @@ int main(int argc, char **argv)
 		case 'r':
 			use_reverse_map = true;
 			break;
+		case 'u': /* use union-find instead of the iterative algorithm */
+			use_union_find = true;
+			break;
+		case 'i': /* previous result in text format, only new edges are given on the input */
+			prevfn = argv[i+1];
+			prev_binary = false;
+			break;
+		case 'I': /* previous result in binary format */
+			prevfn = argv[i+1];
+			prev_binary = true;
+			break;
+		case 's': /* write the result in binary format as well */
+			snapfn = argv[i+1];
+			break;
+		case 'x': /* write an index of the result that can be used by sccs_lookup */
+			idxfn = argv[i+1];
+			break;
+		case 'T': /* time-ordered mode, third column is the timestamp (integer) */
+			time_mode = true;
+			break;
+		case 'C': /* cutoffs (comma-separated, or @file) */
+			cutoffs = argv[i+1];
+			break;
+		case 'E': /* write merge events in time-ordered or weighted mode */
+			events = true;
+			break;
+		case 'w': /* weighted mode, third column is the weight, edges are processed in decreasing order */
+			weighted = true;
+			break;
+		case 'D': /* extract components at the cutoffs from merge events written with -E before */
+			dendfn = argv[i+1];
+			break;
+		case 'L': /* write a binary log of merges during processing */
+			mergefn = argv[i+1];
+			break;
+		case 'g': /* input is (group ID, member ID) pairs, lines of each group are consecutive */
+			groups = 1;
+			break;
+		case 'G': /* input is (group ID, member ID) pairs in any order */
+			groups = 2;
+			break;
+		case 'H': /* each line is a hyperedge, all node IDs on it are in the same component */
+			hyper = true;
+			break;
+		case 'c': { /* columns of the node IDs in the input (1-based, comma-separated) */
+			char* c = 0;
+			c1 = strtoul(argv[i+1],&c,10);
+			c2 = (c && *c == ',') ? strtoul(c+1,0,10) : 0;
+			if(c1 == 0 || c2 == 0 || c1 == c2) {
+				fprintf(stderr,"Invalid columns: %s!\n",argv[i+1]);
+				return 1;
+			}
+			c1--;
+			c2--;
+			break;
+		}
 		default:
 			fprintf(stderr,"Unknown parameter: %s!\n",argv[i]);
 			break;
 	}
 	
-	if(n1 == 0) {
-		fprintf(stderr,"Error: no buffer size specified!\n");
+	if(time_mode || weighted) {
+		if(time_mode && weighted) {
+			fprintf(stderr,"Error: -T and -w cannot be used together!\n");
+			return 1;
+		}
+		if(prevfn || snapfn || idxfn || mergefn || c1 != 0 || c2 != 1 || groups || hyper) {
+			fprintf(stderr,"Error: -i, -I, -s, -x, -L, -c, -g, -G and -H cannot be used in time-ordered or weighted mode!\n");
+			return 1;
+		}
+		if(time_mode) {
+			std::vector<int64_t> c;
+			if(cutoffs && !read_cutoffs(cutoffs,c)) return 1;
+			if(dendfn) return run_dendrogram(dendfn,c,std::less<int64_t>());
+			if(n1 == 0) {
+				fprintf(stderr,"Error: no buffer size specified!\n");
+				return 1;
+			}
+			return run_ordered(n1,tmpfn,c,events,std::less<int64_t>());
+		}
+		std::vector<double> c;
+		if(cutoffs && !read_cutoffs(cutoffs,c)) return 1;
+		if(dendfn) return run_dendrogram(dendfn,c,std::greater<double>());
+		if(n1 == 0) {
+			fprintf(stderr,"Error: no buffer size specified!\n");
+			return 1;
+		}
+		return run_ordered(n1,tmpfn,c,events,std::greater<double>());
+	}
+	if(dendfn) {
+		fprintf(stderr,"Error: -D can only be used with -T or -w!\n");
+		return 1;
+	}
+	
+	if(hyper && (groups || c1 != 0 || c2 != 1)) {
+		fprintf(stderr,"Error: -H cannot be used together with -c, -g or -G!\n");
 		return 1;
 	}
 	
-	void* buf = MAP_FAILED;
-	uint64_t s = n1*2*sizeof(uint32_t);
-	int f = -1;
+	/* groups with the union-find algorithm: the edges are not stored, but
+	 * added to the union-find structure directly while reading (not in
+	 * incremental mode, where the nodes need to be replaced by their
+	 * previous component IDs first) */
+	bool stream = groups && use_union_find && !prevfn;
 	
-	if(tmpfn) {
-		/* note: O_EXCL makes sure the file does not already exist */
-		f = open(tmpfn,O_CREAT | O_RDWR | O_EXCL,S_IRUSR | S_IWUSR);
-		if(f == -1) {
-			fprintf(stderr,"Error opening temporary file %s!\n",tmpfn);
-			return 2;
-		}
-		if(ftruncate(f,s) == -1) {
-			fprintf(stderr,"Error setting file size on temporary file %s to %lu!\n",tmpfn,s);
-			close(f);
-			return 3;
-		}
-		buf = mmap(0,s,PROT_READ | PROT_WRITE,MAP_SHARED,f,0);
-		if(buf == MAP_FAILED) {
-			fprintf(stderr,"Error creating buffers from file %s!\n",tmpfn);
-		}
-		unlink(tmpfn); /* note: do not keep the temporary file
-			-- might be confusing for some people that it's still taking up disk space? */
+	if(n1 == 0 && !stream) {
+		fprintf(stderr,"Error: no buffer size specified!\n");
+		return 1;
 	}
-	else {
-		/* just allocate a lot of memory */
-		buf = mmap(0,s,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
-		if(buf == MAP_FAILED) {
-			fprintf(stderr,"Error allocating memory for the buffers!\n");
-			return 11;
-		}
+	
+	/* in hyperedge mode, the buffer stores all node IDs (n1 in total),
+	 * otherwise, the two node IDs of each edge (n1 edges) */
+	sccs_buffer buf;
+	uint32_t* u1 = 0;
+	uint32_t* u2 = 0;
+	if(!stream) {
+		int ret = buf.alloc(n1*(hyper ? 1 : 2)*sizeof(uint32_t),tmpfn);
+		if(ret) return ret;
+		u1 = (uint32_t*)buf.buf;
+		u2 = u1 + n1;
 	}
+	std::vector<uint64_t> offsets; /* start of each hyperedge in u1 */
 	
-	uint32_t* u1 = (uint32_t*)buf;
-	uint32_t* u2 = u1 + n1;
+	sccs_merge_log<uint32_t,ch32> mlog;
+	if(mergefn && !mlog.open(mergefn)) {
+		fprintf(stderr,"Error opening output file %s!\n",mergefn);
+		return 1;
+	}
+	
+	/* assignement of users to sccs -- key is userid, stored value is sccid */
+	std::unordered_map<uint32_t,uint32_t,ch32> sccs;
 	
 	time_t t1;
 	
 	t1 = time(0);
 	fprintf(stderr,"%sreading input\n",ctime(&t1));
 	
-	uint64_t n = read_graph(u1,u2,stdin,n1);
+	uint64_t n, ngroups = 0;
+	if(stream) sccs_union_find_gen([&n,&ngroups,groups,c1,c2](auto&& f) {
+			n = read_groups_f(STDIN_FILENO,groups == 1,ngroups,[&f](uint32_t x, uint32_t y) {
+					f(x,y);
+					return true;
+				},c1,c2);
+		},sccs,stderr,mergefn ? &mlog : 0);
+	else if(hyper) n = read_hyperedges(u1,offsets,STDIN_FILENO,n1);
+	else if(groups) n = read_groups(u1,u2,STDIN_FILENO,n1,groups == 1,ngroups,c1,c2);
+	else n = read_graph(u1,u2,STDIN_FILENO,n1,c1,c2);
 	if(n == 0) return 1;
+	/* number of node IDs stored in u1 and u2 (u2 is not used for hyperedges) */
+	uint64_t nu1 = hyper ? offsets.back() : n;
+	uint64_t nu2 = hyper ? 0 : n;
 
 	t1 = time(0);
-	fprintf(stderr,"%s%lu edges read\n",ctime(&t1),n);
+	if(hyper) fprintf(stderr,"%s%lu hyperedges read, %lu node IDs in total\n",ctime(&t1),n,nu1);
+	else if(groups) fprintf(stderr,"%s%lu groups read, %lu edges created\n",ctime(&t1),ngroups,n);
+	else fprintf(stderr,"%s%lu edges read\n",ctime(&t1),n);
 	
-	/* assignement of users to sccs -- key is userid, stored value is sccid */
-	std::unordered_map<uint32_t,uint32_t,ch32> sccs;
-	std::unordered_map<uint32_t,uint32_t,ch32> merge; //keep track of sccs to merge
-	/* optional extra copy of assignement of users to sccs
-	 *  -- key is sccid, stored value is userid
-	 * used to be able to update sccs more efficiently */
-	std::unordered_multimap<uint32_t,uint32_t,ch32> sccs2;
-	
-	//1. just get all users
-	for(uint64_t i=0;i<n;i++) {
-		/* note: at first each user is in a separate scc, so the sccs
-		 * multimap can be used to find all unique userids */
-		auto it = sccs.find(u1[i]);
-		if(it == sccs.end()) sccs.insert(std::make_pair(u1[i],u1[i]));
-		it = sccs.find(u2[i]);
-		if(it == sccs.end()) sccs.insert(std::make_pair(u2[i],u2[i]));
+	FILE* snap = 0;
+	if(snapfn) {
+		snap = fopen(snapfn,"w");
+		if(!snap) {
+			fprintf(stderr,"Error opening output file %s!\n",snapfn);
+			return 1;
+		}
 	}
 	
-	t1 = time(0);
-	fprintf(stderr,"%s%lu users in total\n",ctime(&t1),sccs.size());
-	
-	//2. iteratively update sccs assignements, always try to lower scc ids
-	unsigned int j = 0;
-	uint64_t k = 0;
-	while(1) {
-		for(uint64_t i=0;i<n;i++) {
-			uint32_t i1 = sccs[u1[i]];
-			uint32_t i2 = sccs[u2[i]];
-			
-			while(i2 == i1 && i<n) {
-				/* remove edges where both addresses already were assigned to
-				 * the same scc -- these will not affect the result anymore */
-				u1[i] = u1[n-1];
-				u2[i] = u2[n-1];
-				i1 = sccs[u1[i]];
-				i2 = sccs[u2[i]];
-				n--;
-			}
-			if(i == n) break; /* no more edges to process */
-			if(i2 < i1) {
-				uint32_t tmp = i2;
-				i2 = i1;
-				i1 = tmp;
-			}
-			
-			// add to the list of merges
-			auto it = merge.find(i2);
-			if(it == merge.end()) merge.insert(std::make_pair(i2,i1));
-			else if(i1 < it->second) it->second = i1;
-		}
-		
-		if(merge.size() == 0) break; //no more updates to do
-		
-		/* go through all updates to do, find the minimum for each SCC edge */
-		{
-			std::vector<typename std::unordered_map<unsigned int,unsigned int,ch32>::iterator> updates;
-			for(auto it = merge.begin();it!=merge.end();++it) {
-				auto it1 = it;
-				auto it2 = merge.find(it1->second);
-				while(it2 != merge.end()) {
-					updates.push_back(std::move(it1));
-					it1 = it2;
-					it2 = merge.find(it1->second);
-				}
-				unsigned int idlast = it1->second;
-				while(!updates.empty()) {
-					updates.back()->second = idlast;
-					updates.pop_back();
-				}
-			}
+	/* incremental mode: replace the nodes in the new edges with their
+	 * component IDs in the previous result, so the components found will
+	 * give the merges needed to the previous components
+	 * note: this relies on component IDs being node IDs in the previous
+	 * result (as in the output of this program), and that node IDs not
+	 * present in the previous result are not used as component IDs there */
+	std::unordered_map<uint32_t,uint32_t,ch32> prev;
+	std::unordered_set<uint32_t,ch32> newnodes;
+	if(prevfn) {
+		for(uint64_t i=0;i<nu1;i++) prev.insert(std::make_pair(u1[i],u1[i]));
+		for(uint64_t i=0;i<nu2;i++) prev.insert(std::make_pair(u2[i],u2[i]));
+		for(const auto& x : prev) newnodes.insert(x.first);
+		if(!read_labels(prevfn,prev_binary,[&prev,&newnodes](uint32_t x, uint32_t l) {
+				auto it = prev.find(x);
+				if(it != prev.end()) { it->second = l; newnodes.erase(x); }
+			})) return 1;
+		if(mergefn) {
+			/* get the size of the previous components that are involved
+			 * (needed for the merge log, requires reading the previous
+			 * result once more) */
+			for(const auto& x : prev) if(!newnodes.count(x.first)) mlog.sizes.insert(std::make_pair(x.second,0));
+			if(!read_labels(prevfn,prev_binary,[&mlog](uint32_t, uint32_t l) {
+					auto it = mlog.sizes.find(l);
+					if(it != mlog.sizes.end()) it->second++;
+				})) return 1;
 		}
-		
-		/* do the updates; simple version which iterates over all users,
-		 * this could be improved by sorting them by sccid */
-		if(sccs2.size() == 0) for(auto it = sccs.begin(); it != sccs.end(); ++it) {
-			uint32_t sccid = it->second;
-			auto it2 = merge.find(sccid);
-			if(it2 != merge.end()) { it->second = it2->second; k++; }
-			/* create the reverse map during the first pass */
-			if(use_reverse_map) sccs2.insert(std::make_pair(it->second,it->first));
+		for(uint64_t i=0;i<nu1;i++) u1[i] = prev[u1[i]];
+		for(uint64_t i=0;i<nu2;i++) u2[i] = prev[u2[i]];
+		t1 = time(0);
+		fprintf(stderr,"%sprevious result read, %lu nodes in the new edges, %lu of them are new\n",
+			ctime(&t1),prev.size(),newnodes.size());
+		prev.clear();
+	}
+	
+	int j = 0;
+	if(stream) { } /* components were already found while reading */
+	else if(hyper) sccs_union_find_csr(offsets.data(),u1,n,sccs,stderr,mergefn ? &mlog : 0);
+	else if(use_union_find) sccs_union_find(u1,u2,n,sccs,stderr,mergefn ? &mlog : 0);
+	else j = sccs_iterative(u1,u2,n,sccs,use_reverse_map,stderr,mergefn ? &mlog : 0);
+	if(mergefn) {
+		if(!mlog.close()) {
+			fprintf(stderr,"Error writing merges to %s!\n",mergefn);
+			j = -1;
 		}
-		/* improved version: scc ids can be searched in the sccs multimap */
-		else for(const auto& sccedge : merge) {
-			/* replace sccedge.first with sccedge.second everywhere */
-			/* note: use C++17 style node access and modification -- does not work until gcc 7.1
-			auto x = sccs2.extract(sccedge.first);
-			if(x.empty()) {
-				fprintf(stderr,"Inconsistent scc mappings: scc %u has no users in it!\n",sccedge.first);
-				k = 0;
-				break;
-			}
-			do {
-				x.key = sccedge.second;
-				sccs[x.value] = sccedge.second;
-				sccs2.insert(x);
-				k++;
-				x = sccs2.extract(sccedge.first);
-			} while(!x.empty()); */
-			auto it = sccs2.find(sccedge.first);
-			if(it == sccs2.end()) {
-				fprintf(stderr,"Inconsistent scc mappings: scc %u has no users in it!\n",sccedge.first);
-				k = 0;
-				break;
-			}
-			do {
-				std::pair<unsigned int,unsigned int> x = *it; /* note: this creates a copy */
-				sccs2.erase(it);
-				x.first = sccedge.second;
-				sccs[x.second] = sccedge.second;
-				sccs2.insert(x);
-				k++;
-				it = sccs2.find(sccedge.first);
-			} while(it != sccs2.end());
+		else {
+			t1 = time(0);
+			fprintf(stderr,"%s%lu merges written to %s\n",ctime(&t1),mlog.size(),mergefn);
 		}
-		if(k == 0) { j = 0; break; } /* error occured previously */
-		
-		j++;
-		t1 = time(0);
-		fprintf(stderr,"%siteration %u, %lu edges remain, %lu sccs / %lu users updated\n",ctime(&t1),j,n,merge.size(),k);
-		merge.clear();
-		k = 0;
+		mlog.sizes.clear();
 	}
 	
 	t1 = time(0);
 	fprintf(stderr,"%sdone processing\n",ctime(&t1));
 	
-	if(j == 0) fprintf(stderr,"Error encountered during processing!\n");
+	if(j < 0) fprintf(stderr,"Error encountered during processing!\n");
+	else if(prevfn) {
+		/* write out only the nodes with changed component IDs: nodes in the
+		 * previous result in components that were merged and all new nodes */
+		uint64_t k = 0;
+		if(!read_labels(prevfn,prev_binary,[&sccs,snap,&k](uint32_t x, uint32_t l) {
+				auto it = sccs.find(l);
+				if(it != sccs.end() && it->second != l) {
+					fprintf(stdout,"%u\t%u\n",x,it->second);
+					l = it->second;
+					k++;
+				}
+				if(snap) write_label_binary(snap,x,l);
+			})) j = -1;
+		else for(uint32_t x : newnodes) {
+			uint32_t l = sccs[x];
+			fprintf(stdout,"%u\t%u\n",x,l);
+			if(snap) write_label_binary(snap,x,l);
+		}
+		t1 = time(0);
+		fprintf(stderr,"%s%lu nodes changed component, %lu new nodes\n",ctime(&t1),k,newnodes.size());
+	}
 	// write output
 	else for(auto it = sccs.begin(); it != sccs.end(); ++it) {
 		fprintf(stdout,"%u\t%u\n",it->first,it->second);
+		if(snap) write_label_binary(snap,it->first,it->second);
 	}
 	
-	munmap(buf,s);
-	if(tmpfn) close(f);
+	if(snap && fclose(snap)) {
+		fprintf(stderr,"Error writing output file %s!\n",snapfn);
+		j = -1;
+	}
 	
-	return 0;
+	if(j >= 0 && idxfn) {
+		/* create the index from the full result -- note: in incremental
+		 * mode, this means reading the previous result again */
+		bool ret;
+		if(prevfn) ret = sccs_index_write(idxfn,[&](auto&& f) -> bool {
+				if(!read_labels(prevfn,prev_binary,[&sccs,&f](uint32_t x, uint32_t l) {
+						auto it = sccs.find(l);
+						f(x,it == sccs.end() ? l : it->second);
+					})) return false;
+				for(uint32_t x : newnodes) f(x,sccs[x]);
+				return true;
+			});
+		else ret = sccs_index_write(idxfn,[&sccs](auto&& f) -> bool {
+				for(const auto& x : sccs) f(x.first,x.second);
+				return true;
+			});
+		t1 = time(0);
+		if(ret) fprintf(stderr,"%sindex written to %s\n",ctime(&t1),idxfn);
+		else {
+			fprintf(stderr,"%sError writing index to %s!\n",ctime(&t1),idxfn);
+			j = -1;
+		}
+	}
+	
+	return j < 0 ? 1 : 0;
 }
-
@@ -0,0 +1,340 @@
+/*
+ * sccs32s_mpi.cpp -- calculate connected components for an undirected graph
+ * 	distributed among multiple processes using MPI
+ *
+ * edges are read by the first process (rank 0) from the standard input
+ * and are distributed among all processes by a hash of the edge; each
+ * process computes the components of its own part of the graph with a
+ * union-find structure (local forest), then the local labels of all nodes
+ * are exchanged and merged until convergence:
+ *   -- each node is "owned" by one process (again, based on a hash of its ID),
+ *     which collects the labels assigned to the node by all processes that
+ *     have it in their part of the graph ("holders")
+ *   -- the owner determines the smallest label and sends it back to all
+ *     holders which have a larger label; the holders merge this into their
+ *     local forest (so that the whole local component will have this label)
+ *   -- the holders send back the new label of all nodes whose label changed
+ *   -- this is repeated until no more labels change
+ * at the end, each node is labeled with the smallest node ID in its
+ * component, so the result is the same as with sccs32s (apart from the
+ * order of lines in the output)
+ *
+ * the final result is collected and written to the standard output by
+ * rank 0
+ *
+ *
+ * Copyright 2016,2018 Kondor Dániel <dkondor@mit.edu>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <unordered_map> // needs c++11
+#include <time.h>
+
+#include <mpi.h>
+
+#include "read_table.h"
+#include "sccs.h"
+
+
+/* maximum number of values sent or received in one MPI call (MPI uses
+ * int for counts and displacements, so this has to be kept below INT_MAX) */
+static const size_t max_msg = 1UL << 26;
+
+/* process owning a node (collecting its labels and writing it to the output) */
+static inline int node_owner(uint32_t x, int nprocs) {
+	return ch32()(x) % nprocs;
+}
+/* process to store an edge -- use a different mixing than for the nodes */
+static inline int edge_owner(uint32_t x, uint32_t y, int nprocs) {
+	return ch32()(x ^ (uint32_t)ch32()(y + 0x9e3779b9U)) % nprocs;
+}
+
+/* send the contents of out[i] to process i (for all i), receive all data
+ * sent to this process in in[i] (for all i) -- all processes need to call
+ * this at the same time; large amounts of data are sent in multiple steps,
+ * with at most max_msg / nprocs values between each pair of processes in
+ * one step, so that the total sent and received stays below max_msg
+ * note: out is cleared after sending */
+static void exchange(std::vector<std::vector<uint32_t> >& out,
+		std::vector<std::vector<uint32_t> >& in, int nprocs) {
+	std::vector<int> scount(nprocs), sdispl(nprocs), rcount(nprocs), rdispl(nprocs);
+	std::vector<size_t> sent(nprocs,0);
+	std::vector<uint32_t> sbuf, rbuf;
+	size_t max_step = max_msg / nprocs;
+	if(max_step == 0) max_step = 1;
+	for(auto& x : in) x.clear();
+	while(1) {
+		int more = 0;
+		int stotal = 0;
+		for(int i=0;i<nprocs;i++) {
+			size_t rem = out[i].size() - sent[i];
+			if(rem > max_step) { rem = max_step; more = 1; }
+			scount[i] = rem;
+			sdispl[i] = stotal;
+			stotal += rem;
+		}
+		sbuf.resize(stotal);
+		for(int i=0;i<nprocs;i++) {
+			std::copy(out[i].begin() + sent[i], out[i].begin() + sent[i] + scount[i], sbuf.begin() + sdispl[i]);
+			sent[i] += scount[i];
+		}
+		MPI_Alltoall(scount.data(),1,MPI_INT,rcount.data(),1,MPI_INT,MPI_COMM_WORLD);
+		int rtotal = 0;
+		for(int i=0;i<nprocs;i++) { rdispl[i] = rtotal; rtotal += rcount[i]; }
+		rbuf.resize(rtotal);
+		MPI_Alltoallv(sbuf.data(),scount.data(),sdispl.data(),MPI_UINT32_T,
+			rbuf.data(),rcount.data(),rdispl.data(),MPI_UINT32_T,MPI_COMM_WORLD);
+		for(int i=0;i<nprocs;i++)
+			in[i].insert(in[i].end(),rbuf.begin() + rdispl[i],rbuf.begin() + rdispl[i] + rcount[i]);
+		/* note: all processes need to do the same number of steps */
+		int more2 = 0;
+		MPI_Allreduce(&more,&more2,1,MPI_INT,MPI_MAX,MPI_COMM_WORLD);
+		if(!more2) break;
+	}
+	for(auto& x : out) x.clear();
+}
+
+/* distribute edges from rank 0 to all processes; flag values are used to
+ * signal the end of input or an error */
+enum { EDGES_MORE = 0, EDGES_DONE = 1, EDGES_ERROR = 2 };
+static int scatter_edges(std::vector<std::vector<uint32_t> >& out,
+		std::vector<uint32_t>& in, int nprocs, int flag) {
+	std::vector<int> scount(nprocs), sdispl(nprocs);
+	std::vector<uint32_t> sbuf;
+	int rcount = 0;
+	for(int i=0,stotal=0;i<(int)out.size();i++) {
+		scount[i] = out[i].size();
+		sdispl[i] = stotal;
+		stotal += scount[i];
+		sbuf.insert(sbuf.end(),out[i].begin(),out[i].end());
+		out[i].clear();
+	}
+	MPI_Bcast(&flag,1,MPI_INT,0,MPI_COMM_WORLD);
+	if(flag == EDGES_ERROR) return flag;
+	MPI_Scatter(scount.data(),1,MPI_INT,&rcount,1,MPI_INT,0,MPI_COMM_WORLD);
+	in.resize(rcount);
+	MPI_Scatterv(sbuf.data(),scount.data(),sdispl.data(),MPI_UINT32_T,
+		in.data(),rcount,MPI_UINT32_T,0,MPI_COMM_WORLD);
+	return flag;
+}
+
+
+int main(int argc, char **argv)
+{
+	MPI_Init(&argc,&argv);
+	int rank, nprocs;
+	MPI_Comm_rank(MPI_COMM_WORLD,&rank);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+
+	/* number of edges to read before sending them to the other processes */
+	size_t batch = 1UL << 22;
+
+	for(int i=1;i<argc;i++) if(argv[i][0] == '-') switch(argv[i][1]) {
+		case 'b': /* batch size */
+			batch = strtoul(argv[i+1],0,10);
+			break;
+		default:
+			if(rank == 0) fprintf(stderr,"Unknown parameter: %s!\n",argv[i]);
+			break;
+	}
+	if(batch == 0 || batch > max_msg / 2) batch = max_msg / 2;
+
+	time_t t1;
+	if(rank == 0) {
+		t1 = time(0);
+		fprintf(stderr,"%sreading input, using %d processes\n",ctime(&t1),nprocs);
+	}
+
+	/* 1. read and distribute edges, build the local forest */
+	union_find<> uf;
+	std::vector<std::vector<uint32_t> > out(nprocs);
+	std::vector<std::vector<uint32_t> > in(nprocs);
+	std::vector<uint32_t> edges;
+	uint64_t nedges = 0;
+	{
+		read_table2 r(stdin); /* note: only used on rank 0 */
+		while(1) {
+			int flag = EDGES_MORE;
+			if(rank == 0) {
+				size_t i = 0;
+				while(i < batch) {
+					if(!r.read_line()) break;
+					uint32_t x, y;
+					if(!r.read(x,y)) {
+						if(r.get_last_error() == T_OVERFLOW) continue; // ignore overflow / negative values
+						break;
+					}
+					auto& o = out[edge_owner(x,y,nprocs)];
+					o.push_back(x);
+					o.push_back(y);
+					i++;
+				}
+				nedges += i;
+				if(i < batch) {
+					if(r.get_last_error() != T_EOF) {
+						r.write_error(stderr);
+						flag = EDGES_ERROR;
+					}
+					else flag = EDGES_DONE;
+				}
+			}
+			flag = scatter_edges(out,edges,nprocs,flag);
+			if(flag == EDGES_ERROR) {
+				MPI_Finalize();
+				return 1;
+			}
+			for(size_t i=0;i+1<edges.size();i+=2) uf.unite(edges[i],edges[i+1]);
+			if(flag == EDGES_DONE) break;
+		}
+	}
+	edges.clear();
+	edges.shrink_to_fit();
+
+	if(rank == 0) {
+		t1 = time(0);
+		fprintf(stderr,"%s%lu edges read\n",ctime(&t1),nedges);
+	}
+
+	/* 2. exchange labels until convergence
+	 * last label sent to the owner for each node in the local forest */
+	std::unordered_map<uint32_t,uint32_t,ch32> sent;
+	/* nodes owned by this process: current (smallest) label */
+	std::unordered_map<uint32_t,uint32_t,ch32> labels;
+	/* nodes owned by this process: processes holding them and the last
+	 * label known for them */
+	std::unordered_multimap<uint32_t,std::pair<int,uint32_t>,ch32> holders;
+	std::vector<uint32_t> changed; /* nodes whose label changed in the current step */
+	unsigned int j = 0;
+	while(1) {
+		/* 2.1. send new labels to the owners */
+		uint64_t nmsg = 0;
+		for(const auto& x : uf.parent) {
+			uint32_t l = uf.find(x.first);
+			auto it = sent.find(x.first);
+			if(it == sent.end()) sent.insert(std::make_pair(x.first,l));
+			else if(it->second != l) it->second = l;
+			else continue;
+			auto& o = out[node_owner(x.first,nprocs)];
+			o.push_back(x.first);
+			o.push_back(l);
+			nmsg++;
+		}
+		exchange(out,in,nprocs);
+
+		/* 2.2. update labels and holders in the owner */
+		changed.clear();
+		for(int i=0;i<nprocs;i++) for(size_t k=0;k+1<in[i].size();k+=2) {
+			uint32_t x = in[i][k];
+			uint32_t l = in[i][k+1];
+			auto it = labels.find(x);
+			if(it == labels.end()) labels.insert(std::make_pair(x,l));
+			else if(l < it->second) it->second = l;
+			bool found = false;
+			auto range = holders.equal_range(x);
+			for(auto it2 = range.first; it2 != range.second; ++it2)
+				if(it2->second.first == i) { it2->second.second = l; found = true; break; }
+			if(!found) holders.insert(std::make_pair(x,std::make_pair(i,l)));
+			changed.push_back(x);
+		}
+
+		/* 2.3. send back the smallest label to holders that do not have it */
+		for(uint32_t x : changed) {
+			uint32_t l = labels[x];
+			auto range = holders.equal_range(x);
+			for(auto it2 = range.first; it2 != range.second; ++it2)
+				if(it2->second.second > l) {
+					it2->second.second = l;
+					auto& o = out[it2->second.first];
+					o.push_back(x);
+					o.push_back(l);
+					nmsg++;
+				}
+		}
+		exchange(out,in,nprocs);
+
+		/* 2.4. merge new labels into the local forest */
+		for(int i=0;i<nprocs;i++) for(size_t k=0;k+1<in[i].size();k+=2)
+			uf.unite(in[i][k],in[i][k+1]);
+
+		uint64_t nmsg2 = 0;
+		MPI_Allreduce(&nmsg,&nmsg2,1,MPI_UINT64_T,MPI_SUM,MPI_COMM_WORLD);
+		j++;
+		if(rank == 0) {
+			t1 = time(0);
+			fprintf(stderr,"%siteration %u, %lu labels exchanged\n",ctime(&t1),j,nmsg2);
+		}
+		if(nmsg2 == 0) break;
+	}
+	sent.clear();
+	holders.clear();
+	uf.parent.clear();
+
+	/* 3. write output -- all processes send their part to rank 0 */
+	uint64_t nnodes = labels.size();
+	uint64_t nnodes2 = 0;
+	MPI_Reduce(&nnodes,&nnodes2,1,MPI_UINT64_T,MPI_SUM,0,MPI_COMM_WORLD);
+	if(rank == 0) {
+		t1 = time(0);
+		fprintf(stderr,"%sdone processing, %lu users in total\n",ctime(&t1),nnodes2);
+		for(const auto& x : labels) fprintf(stdout,"%u\t%u\n",x.first,x.second);
+		std::vector<uint32_t> buf;
+		for(int i=1;i<nprocs;i++) while(1) {
+			MPI_Status st;
+			int cnt;
+			MPI_Probe(i,0,MPI_COMM_WORLD,&st);
+			MPI_Get_count(&st,MPI_UINT32_T,&cnt);
+			buf.resize(cnt);
+			MPI_Recv(buf.data(),cnt,MPI_UINT32_T,i,0,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+			if(cnt == 0) break; /* empty message signals the end */
+			for(int k=0;k+1<cnt;k+=2) fprintf(stdout,"%u\t%u\n",buf[k],buf[k+1]);
+		}
+	}
+	else {
+		std::vector<uint32_t> buf;
+		auto it = labels.begin();
+		while(1) {
+			buf.clear();
+			for(;it != labels.end() && buf.size() < max_msg; ++it) {
+				buf.push_back(it->first);
+				buf.push_back(it->second);
+			}
+			MPI_Send(buf.data(),buf.size(),MPI_UINT32_T,0,0,MPI_COMM_WORLD);
+			if(buf.size() == 0) break;
+		}
+	}
+
+	MPI_Finalize();
+	return 0;
+}
+
@@ -0,0 +1,116 @@
+/*
+ * sccs_capi.cpp -- C interface to the connected components library,
+ * 	see sccs_capi.h for documentation
+ *
+ * can be compiled as a shared library, e.g.
+ * g++ -shared -fPIC -o libsccs.so sccs_capi.cpp -std=gnu++14 -O3
+ *
+ * Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <new>
+#include "sccs.h"
+#include "sccs_capi.h"
+
+struct sccs_result {
+	ConnectedComponents<uint32_t> cc;
+};
+
+static bool compute(ConnectedComponents<uint32_t>& cc, const uint32_t* u,
+		const uint32_t* v, size_t n, int engine) {
+	sccs_options opts;
+	if(engine == SCCS_ENGINE_ITERATIVE) opts.engine = sccs_engine::iterative;
+	else if(engine != SCCS_ENGINE_UNION_FIND) return false;
+	cc.add_edges(u,v,n);
+	return cc.compute(opts);
+}
+
+extern "C" {
+
+int sccs_compute(const uint32_t* u, const uint32_t* v, size_t n,
+		uint32_t* labels_out, int engine) {
+	try {
+		ConnectedComponents<uint32_t> cc;
+		if(!compute(cc,u,v,n,engine)) return 1;
+		for(size_t i=0;i<n;i++) labels_out[i] = cc.component_of(u[i]);
+	}
+	catch(...) { return 2; } /* e.g. out of memory */
+	return 0;
+}
+
+int sccs_compute_nodes(const uint32_t* u, const uint32_t* v, size_t n,
+		const uint32_t* nodes, size_t n_nodes, uint32_t* labels_out, int engine) {
+	try {
+		ConnectedComponents<uint32_t> cc;
+		if(!compute(cc,u,v,n,engine)) return 1;
+		for(size_t i=0;i<n_nodes;i++) labels_out[i] = cc.component_of(nodes[i]);
+	}
+	catch(...) { return 2; }
+	return 0;
+}
+
+sccs_result* sccs_compute_result(const uint32_t* u, const uint32_t* v, size_t n, int engine) {
+	sccs_result* r = new(std::nothrow) sccs_result;
+	if(!r) return 0;
+	try {
+		if(compute(r->cc,u,v,n,engine)) return r;
+	}
+	catch(...) { }
+	delete r;
+	return 0;
+}
+
+size_t sccs_result_nodes(const sccs_result* r) {
+	return r ? r->cc.size() : 0;
+}
+
+size_t sccs_result_components(const sccs_result* r) {
+	return r ? r->cc.num_components() : 0;
+}
+
+void sccs_result_export(const sccs_result* r, uint32_t* nodes_out, uint32_t* labels_out) {
+	if(!r) return;
+	size_t i = 0;
+	for(const auto& x : r->cc) nodes_out[i++] = x.first;
+	std::sort(nodes_out,nodes_out + i);
+	for(size_t j=0;j<i;j++) labels_out[j] = r->cc.component_of(nodes_out[j]);
+}
+
+void sccs_result_lookup(const sccs_result* r, const uint32_t* nodes, size_t n_nodes, uint32_t* labels_out) {
+	if(!r) return;
+	for(size_t i=0;i<n_nodes;i++) labels_out[i] = r->cc.component_of(nodes[i]);
+}
+
+void sccs_result_free(sccs_result* r) {
+	delete r;
+}
+
+} /* extern "C" */
+
@@ -0,0 +1,92 @@
+/*
+ * sccs_capi.h -- C interface to the connected components library (sccs.h)
+ *
+ * all functions take the edges of the graph as two arrays (u and v) of
+ * n node IDs each (edge i is between u[i] and v[i]); the arrays are not
+ * copied or modified; nodes are labeled by the smallest node ID in their
+ * component (same as sccs32s)
+ *
+ * engine can be SCCS_ENGINE_UNION_FIND (faster) or SCCS_ENGINE_ITERATIVE
+ * (the original algorithm in sccs32s, uses more memory here as it copies
+ * the edges)
+ *
+ * functions returning int give 0 on success and nonzero on error
+ *
+ * Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _SCCS_CAPI_H
+#define _SCCS_CAPI_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCCS_ENGINE_UNION_FIND 0
+#define SCCS_ENGINE_ITERATIVE 1
+
+/* calculate components, store the component of each edge in labels_out
+ * (i.e. labels_out[i] is the component of both u[i] and v[i]; labels_out
+ * should have space for n elements) */
+int sccs_compute(const uint32_t* u, const uint32_t* v, size_t n,
+	uint32_t* labels_out, int engine);
+
+/* calculate components, store the component of the given nodes in
+ * labels_out (labels_out should have space for n_nodes elements; nodes
+ * not in any edge are their own component) */
+int sccs_compute_nodes(const uint32_t* u, const uint32_t* v, size_t n,
+	const uint32_t* nodes, size_t n_nodes, uint32_t* labels_out, int engine);
+
+/* handle to the full result of a calculation, to be used if all nodes
+ * are needed, or if the nodes to query are not known in advance */
+typedef struct sccs_result sccs_result;
+
+/* calculate components, return the result (or NULL on error) */
+sccs_result* sccs_compute_result(const uint32_t* u, const uint32_t* v, size_t n, int engine);
+/* number of nodes and components in the result */
+size_t sccs_result_nodes(const sccs_result* r);
+size_t sccs_result_components(const sccs_result* r);
+/* store all nodes and their components in the given arrays (both should
+ * have space for sccs_result_nodes(r) elements); nodes are sorted by ID */
+void sccs_result_export(const sccs_result* r, uint32_t* nodes_out, uint32_t* labels_out);
+/* store the component of the given nodes in labels_out */
+void sccs_result_lookup(const sccs_result* r, const uint32_t* nodes, size_t n_nodes, uint32_t* labels_out);
+/* free all memory used by the result */
+void sccs_result_free(sccs_result* r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SCCS_CAPI_H */
+
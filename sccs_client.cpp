@@ -0,0 +1,197 @@
+/*
+ * sccs_client.cpp -- simple client for sccsd
+ *
+ * usage: sccs_client -s socket [-u|-f|-c|-S|-T]
+ *   -u: read edges (pairs of node IDs) from the standard input and add them,
+ *     waits until all are processed by the daemon
+ *   -f: read node IDs from the standard input, write them with their
+ *     component ID (this is the default)
+ *   -c: read pairs of node IDs from the standard input, write them with 1
+ *     or 0 depending on whether they are in the same component
+ *   -S: ask the daemon to write a snapshot now
+ *   -T: write the number of nodes and components
+ * input is sent to the daemon in batches (size can be given by the -b option)
+ *
+ * Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "read_table.h"
+#include "sccsd.h"
+
+static const char* const status_desc[] = {"OK", "Unknown request",
+	"Request too large", "Error writing snapshot", "Server is shutting down"};
+
+/* send one request, read the header of the reply
+ * returns true if the request was successful */
+static bool request(int fd, uint32_t op, const std::vector<uint32_t>& data, uint32_t n, sccsd_header& r) {
+	sccsd_header h = {op,n};
+	if(!sccsd_write(fd,&h,sizeof(h)) ||
+			(data.size() && !sccsd_write(fd,data.data(),data.size()*sizeof(uint32_t))) ||
+			!sccsd_read(fd,&r,sizeof(r))) {
+		fprintf(stderr,"Error communicating with the server!\n");
+		return false;
+	}
+	if(r.op != SCCSD_OK) {
+		fprintf(stderr,"Error from the server: %s!\n",
+			r.op < sizeof(status_desc)/sizeof(status_desc[0]) ? status_desc[r.op] : "Unknown error");
+		return false;
+	}
+	return true;
+}
+
+/* process one batch of input */
+static bool process_batch(int fd, uint32_t op, const std::vector<uint32_t>& buf) {
+	sccsd_header r;
+	uint32_t n = (op == SCCSD_FIND) ? buf.size() : buf.size() / 2;
+	if(!request(fd,op,buf,n,r)) return false;
+	if(op == SCCSD_FIND) {
+		std::vector<uint32_t> res(r.n);
+		if(r.n != n || !sccsd_read(fd,res.data(),n*sizeof(uint32_t))) return false;
+		for(uint32_t i=0;i<n;i++) fprintf(stdout,"%u\t%u\n",buf[i],res[i]);
+	}
+	if(op == SCCSD_CONNECTED) {
+		std::vector<uint8_t> res(r.n);
+		if(r.n != n || !sccsd_read(fd,res.data(),n)) return false;
+		for(uint32_t i=0;i<n;i++) fprintf(stdout,"%u\t%u\t%u\n",buf[2*i],buf[2*i+1],(unsigned int)res[i]);
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	char* sockfn = 0;
+	uint32_t op = SCCSD_FIND;
+	size_t batch = 1UL << 16;
+
+	for(int i=1;i<argc;i++) if(argv[i][0] == '-') switch(argv[i][1]) {
+		case 's': /* socket to connect to, need to be given */
+			sockfn = argv[i+1];
+			break;
+		case 'u':
+			op = SCCSD_UNION;
+			break;
+		case 'f':
+			op = SCCSD_FIND;
+			break;
+		case 'c':
+			op = SCCSD_CONNECTED;
+			break;
+		case 'S':
+			op = SCCSD_SNAPSHOT;
+			break;
+		case 'T':
+			op = SCCSD_STATS;
+			break;
+		case 'b': /* batch size */
+			batch = strtoul(argv[i+1],0,10);
+			break;
+		default:
+			fprintf(stderr,"Unknown parameter: %s!\n",argv[i]);
+			break;
+	}
+	if(batch == 0 || batch > sccsd_max_request) batch = sccsd_max_request;
+
+	if(!sockfn) {
+		fprintf(stderr,"Error: no socket given!\n");
+		return 1;
+	}
+	struct sockaddr_un addr;
+	memset(&addr,0,sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(strlen(sockfn) >= sizeof(addr.sun_path)) {
+		fprintf(stderr,"Error: socket name too long!\n");
+		return 1;
+	}
+	strcpy(addr.sun_path,sockfn);
+	int fd = socket(AF_UNIX,SOCK_STREAM,0);
+	if(fd == -1 || connect(fd,(struct sockaddr*)&addr,sizeof(addr)) == -1) {
+		fprintf(stderr,"Error connecting to %s!\n",sockfn);
+		return 2;
+	}
+
+	std::vector<uint32_t> buf;
+	sccsd_header r;
+	if(op == SCCSD_SNAPSHOT) {
+		if(!request(fd,op,buf,0,r)) return 1;
+	}
+	else if(op == SCCSD_STATS) {
+		uint64_t tmp[2];
+		if(!request(fd,op,buf,0,r) || r.n != 2 || !sccsd_read(fd,tmp,sizeof(tmp))) return 1;
+		fprintf(stdout,"%lu nodes, %lu components\n",tmp[0],tmp[1]);
+	}
+	else {
+		read_table2 rt(stdin);
+		size_t n = 0;
+		while(rt.read_line()) {
+			uint32_t x, y;
+			if(op == SCCSD_FIND) {
+				if(!rt.read(x)) break;
+				buf.push_back(x);
+			}
+			else {
+				if(!rt.read(x,y)) {
+					/* ignore overflow / negative values when adding edges (same as sccs32s) */
+					if(op == SCCSD_UNION && rt.get_last_error() == T_OVERFLOW) continue;
+					break;
+				}
+				buf.push_back(x);
+				buf.push_back(y);
+			}
+			n++;
+			if(n == batch) {
+				if(!process_batch(fd,op,buf)) return 1;
+				buf.clear();
+				n = 0;
+			}
+		}
+		if(rt.get_last_error() != T_EOF) {
+			fprintf(stderr,"Error reading input: ");
+			rt.write_error(stderr);
+			return 1;
+		}
+		if(n && !process_batch(fd,op,buf)) return 1;
+		/* wait until all edges are added */
+		buf.clear();
+		if(op == SCCSD_UNION && !request(fd,SCCSD_SYNC,buf,0,r)) return 1;
+	}
+
+	close(fd);
+	return 0;
+}
+
@@ -33,12 +33,78 @@
 
 
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
 #include <vector>
+#include <string>
+#include <array>
 #include <algorithm>
 #include <utility>
+#include <thread>
+#include <errno.h>
+#include <sys/resource.h>
 #include "read_table.h"
+#include "sccs.h"
 
-int read_sccs(const char* fn, std::vector<std::pair<unsigned int,unsigned int> >& sccs) {
+/* run f(i) for 0 <= i < nthreads in separate threads */
+template<class F>
+void run_threads(unsigned int nthreads, F&& f) {
+	if(nthreads <= 1) { f(0U); return; }
+	std::vector<std::thread> threads;
+	for(unsigned int i=0;i<nthreads;i++) threads.emplace_back(f,i);
+	for(auto& t : threads) t.join();
+}
+
+/* file mapped to memory (read-only) */
+struct mapped_file {
+	const char* p;
+	size_t len;
+	mapped_file() : p(0),len(0) { }
+	~mapped_file() { if(p) munmap((void*)p,len); }
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator = (const mapped_file&) = delete;
+	/* map the given file, returns false if it is not a regular file
+	 * that can be mapped (an empty file is OK, p is null then) */
+	bool open(const char* fn) {
+		int fd = ::open(fn,O_RDONLY);
+		if(fd == -1) return false;
+		struct stat st;
+		bool ret = false;
+		if(fstat(fd,&st) == 0 && S_ISREG(st.st_mode)) {
+			len = st.st_size;
+			ret = true;
+			if(len) {
+				void* tmp = mmap(0,len,PROT_READ,MAP_PRIVATE,fd,0);
+				if(tmp == MAP_FAILED) { ret = false; len = 0; }
+				else p = (const char*)tmp;
+			}
+		}
+		close(fd);
+		return ret;
+	}
+};
+
+/* read a labeling from the given file (or stdin if fn is null), calling
+ * f(node,label) for each line; f can return false to stop reading
+ * if binary == true, the file is a binary file of pairs of 32-bit node
+ * IDs and labels in native byte order (e.g. the output of sccs32s -s),
+ * it is mapped to memory and not parsed
+ * returns 0 on success */
+template<class F>
+int read_sccs_f(const char* fn, bool binary, F&& f) {
+	if(binary) {
+		mapped_file m;
+		if(!fn || !m.open(fn) || m.len % (2*sizeof(uint32_t))) {
+			fprintf(stderr,"Error opening binary file %s!\n",fn ? fn : "(stdin)");
+			return 1;
+		}
+		madvise((void*)m.p,m.len,MADV_SEQUENTIAL);
+		const uint32_t* x = (const uint32_t*)m.p;
+		size_t n = m.len / (2*sizeof(uint32_t));
+		for(size_t i=0;i<n;i++) if(!f(x[2*i],x[2*i+1])) break;
+		return 0;
+	}
 	FILE* f1 = stdin;
 	if(fn) {
 		f1 = fopen(fn,"r");
@@ -49,24 +115,789 @@ int read_sccs(const char* fn, std::vector<std::pair<unsigned int,unsigned int> >
 	}
 	read_table2 rt(f1);
 	if(fn) rt.set_fn(fn);
+	bool stopped = false;
+	for(const auto& x : rt.rows<uint32_t,uint32_t>())
+		if(!f(std::get<0>(x),std::get<1>(x))) { stopped = true; break; }
+	if(fn) fclose(f1);
+	if(!stopped && rt.get_last_error() != T_EOF) {
+		fprintf(stderr,"Error reading input: ");
+		rt.write_error(stderr);
+		return 1;
+	}
+	return 0;
+}
+
+/* count the lines in a file quickly (to reserve memory before reading it)
+ * returns 0 if fn is null (stdin) or on error */
+uint64_t count_lines(const char* fn) {
+	if(!fn) return 0;
+	int fd = open(fn,O_RDONLY);
+	if(fd == -1) return 0;
+	const size_t bufsize = 1UL << 20;
+	std::vector<char> buf(bufsize);
+	uint64_t n = 0;
+	ssize_t r;
+	while((r = read(fd,buf.data(),bufsize)) > 0) {
+		const char* p = buf.data();
+		const char* end = p + r;
+		while((p = (const char*)memchr(p,'\n',end - p))) { n++; p++; }
+	}
+	close(fd);
+	return r == 0 ? n : 0;
+}
+
+/* read a labeling into an array of node ID, label pairs packed into
+ * 64-bit integers (node ID in the upper 32 bits); n is the expected
+ * number of lines (0 if not known) */
+int read_sccs(const char* fn, bool binary, std::vector<uint64_t>& sccs, uint64_t n) {
+	if(!n && !binary) n = count_lines(fn);
+	sccs.reserve(n);
+	return read_sccs_f(fn,binary,[&sccs](unsigned int x, unsigned int y) {
+		sccs.push_back((((uint64_t)x) << 32) | y);
+		return true;
+	});
+}
+
+/* same, but using nthreads threads: binary files are converted in
+ * parallel, text files are split into chunks at line boundaries and each
+ * chunk is parsed separately; falls back to read_sccs() if the input is
+ * not a regular file */
+int load_sccs(const char* fn, bool binary, std::vector<uint64_t>& sccs, uint64_t n, unsigned int nthreads) {
+	if(nthreads <= 1 || !fn) return read_sccs(fn,binary,sccs,n);
+	if(binary) {
+		mapped_file m;
+		if(!m.open(fn)) return read_sccs(fn,binary,sccs,n);
+		if(m.len % (2*sizeof(uint32_t))) {
+			fprintf(stderr,"Invalid size for binary file %s!\n",fn);
+			return 1;
+		}
+		size_t n1 = m.len / (2*sizeof(uint32_t));
+		const uint32_t* x = (const uint32_t*)m.p;
+		sccs.resize(n1);
+		run_threads(nthreads,[&](unsigned int t) {
+			for(size_t i = n1*t/nthreads; i < n1*(t+1)/nthreads; i++)
+				sccs[i] = (((uint64_t)x[2*i]) << 32) | x[2*i+1];
+		});
+		return 0;
+	}
+	read_table_parallel rp(fn,nthreads);
+	if(!rp.ok()) {
+		fprintf(stderr,"Error opening file %s!\n",fn);
+		return 1;
+	}
+	std::vector<std::vector<uint64_t> > parts(rp.size());
+	bool ok = rp.run([&parts,n,nthreads](read_table2& rt, unsigned int t) {
+		if(n) parts[t].reserve(n/nthreads + n/(8*nthreads));
+		for(const auto& x : rt.rows<uint32_t,uint32_t>())
+			parts[t].push_back((((uint64_t)std::get<0>(x)) << 32) | std::get<1>(x));
+		if(rt.get_last_error() == T_EOF) return true;
+		fprintf(stderr,"Error reading input: ");
+		rt.write_error(stderr);
+		return false;
+	});
+	if(!ok) return 1;
+	size_t total = 0;
+	for(const auto& p : parts) total += p.size();
+	sccs.reserve(total);
+	for(auto& p : parts) {
+		sccs.insert(sccs.end(),p.begin(),p.end());
+		std::vector<uint64_t>().swap(p);
+	}
+	return 0;
+}
+
+/* load both files concurrently (each with nthreads threads)
+ * returns 0 on success */
+int load_both(const char* fn1, const char* fn2, bool binary, std::vector<uint64_t>& sccs1,
+		std::vector<uint64_t>& sccs2, uint64_t n1, unsigned int nthreads) {
+	int ret1 = 0;
+	std::thread t1([&]() { ret1 = load_sccs(fn1,binary,sccs1,n1,nthreads); });
+	int ret2 = load_sccs(fn2,binary,sccs2,0,nthreads);
+	t1.join();
+	return (ret1 || ret2) ? 1 : 0;
+}
+
+/* parallel LSD radix sort of 64-bit values by their bits from lo upwards
+ * (lo = 32 sorts by node IDs in the above format), using tmp as scratch
+ * space (with space for n elements); each pass sorts by 8 bits, passes
+ * where all elements have the same digit are skipped; the sort is stable */
+void radix_sort64(uint64_t* a, uint64_t* tmp, size_t n, unsigned int nthreads, unsigned int lo = 0) {
+	const unsigned int bits = 8;
+	const size_t nb = 1UL << bits;
+	if(nthreads < 1) nthreads = 1;
+	std::vector<size_t> cnt(nthreads*nb);
+	uint64_t* src = a;
+	uint64_t* dst = tmp;
+	for(unsigned int shift = lo; shift < 64; shift += bits) {
+		std::fill(cnt.begin(),cnt.end(),0);
+		run_threads(nthreads,[&](unsigned int t) {
+			size_t* c = cnt.data() + t*nb;
+			for(size_t i = n*t/nthreads; i < n*(t+1)/nthreads; i++) c[(src[i] >> shift) & (nb - 1)]++;
+		});
+		/* offset for each digit and thread: all previous digits, then
+		 * the same digit in previous threads */
+		size_t sum = 0;
+		bool skip = false;
+		for(size_t d=0;d<nb;d++) {
+			size_t sum1 = sum;
+			for(unsigned int t=0;t<nthreads;t++) {
+				size_t c = cnt[t*nb + d];
+				cnt[t*nb + d] = sum;
+				sum += c;
+			}
+			if(sum - sum1 == n) skip = true;
+		}
+		if(skip) continue;
+		run_threads(nthreads,[&](unsigned int t) {
+			size_t* c = cnt.data() + t*nb;
+			for(size_t i = n*t/nthreads; i < n*(t+1)/nthreads; i++) dst[c[(src[i] >> shift) & (nb - 1)]++] = src[i];
+		});
+		std::swap(src,dst);
+	}
+	if(src != a) memcpy(a,src,n*sizeof(uint64_t));
+}
+
+
+/* number of nodes for each pair of labels (label in the first dataset,
+ * label in the second dataset) -- this gives the mapping between labels
+ * in both directions at once: the two labelings are equivalent if each
+ * label appears in only one pair, otherwise all nodes in pairs where
+ * either label appears in multiple pairs are counted as mismatches */
+struct label_pairs {
+	flat_map<uint64_t,uint64_t,ch64> pairs;
+	uint64_t found; /* number of nodes found in both datasets */
+	uint64_t missing; /* nodes in the second dataset not found in the first one */
+	std::vector<unsigned int> missing_ids; /* first few of these to report */
+	static const size_t max_report = 10;
+
+	label_pairs() : found(0),missing(0) { }
+	void add(unsigned int l1, unsigned int l2) {
+		auto x = pairs.insert((((uint64_t)l1) << 32) | l2,0);
+		(*(x.first))++;
+		found++;
+	}
+	void add_missing(unsigned int x) {
+		if(missing_ids.size() < max_report) missing_ids.push_back(x);
+		missing++;
+	}
+	void merge(const label_pairs& lp) {
+		lp.pairs.for_each([this](uint64_t p, uint64_t cnt) { *(pairs.insert(p,0).first) += cnt; });
+		found += lp.found;
+		missing += lp.missing;
+		for(unsigned int x : lp.missing_ids) if(missing_ids.size() < max_report) missing_ids.push_back(x);
+	}
+
+	/* write the differences found (if any) to stderr, n1 is the total
+	 * number of nodes in the first dataset
+	 * note: nodes in the second dataset are assumed to be unique
+	 * returns true if the two labelings are the same */
+	bool report(uint64_t n1) const {
+		flat_map<uint32_t,uint32_t> d1, d2; /* number of pairs each label appears in */
+		pairs.for_each([&d1,&d2](uint64_t p, uint64_t) {
+			(*(d1.insert(p >> 32,0).first))++;
+			(*(d2.insert(p & 0xFFFFFFFFUL,0).first))++;
+		});
+		uint64_t nodes = 0, c1 = 0, c2 = 0;
+		pairs.for_each([&d1,&d2,&nodes](uint64_t p, uint64_t cnt) {
+			if(*(d1.find(p >> 32)) > 1 || *(d2.find(p & 0xFFFFFFFFUL)) > 1) nodes += cnt;
+		});
+		d1.for_each([&c1](uint32_t, uint32_t d) { if(d > 1) c1++; });
+		d2.for_each([&c2](uint32_t, uint32_t d) { if(d > 1) c2++; });
+		for(unsigned int x : missing_ids) fprintf(stderr,"ID %u not found in the first dataset!\n",x);
+		if(missing) fprintf(stderr,"%lu nodes in the second dataset are not in the first one!\n",missing);
+		if(n1 > found) fprintf(stderr,"%lu nodes in the first dataset are not in the second one!\n",n1 - found);
+		if(nodes) fprintf(stderr,"%lu nodes are in different components in the two datasets "
+			"(%lu components in the first and %lu components in the second dataset differ)!\n",nodes,c1,c2);
+		return !(missing || n1 > found || nodes);
+	}
+
+	/* write measures of similarity between the two labelings (considering
+	 * nodes found in both only) to f: adjusted Rand index, normalized
+	 * mutual information (normalized by the mean of the entropies) and
+	 * variation of information (using natural logarithm) */
+	void write_similarity(FILE* f) const {
+		flat_map<uint32_t,uint64_t> s1, s2; /* size of components */
+		pairs.for_each([&s1,&s2](uint64_t p, uint64_t cnt) {
+			*(s1.insert(p >> 32,0).first) += cnt;
+			*(s2.insert(p & 0xFFFFFFFFUL,0).first) += cnt;
+		});
+		const long double n = found;
+		/* sums of pairs of nodes in the same cell / row / column */
+		long double p12 = 0.0L, p1 = 0.0L, p2 = 0.0L;
+		/* entropies and mutual information */
+		long double h1 = 0.0L, h2 = 0.0L, mi = 0.0L;
+		pairs.for_each([&](uint64_t p, uint64_t cnt) {
+			long double c = cnt;
+			p12 += c*(c - 1.0L)/2.0L;
+			long double a = *(s1.find(p >> 32));
+			long double b = *(s2.find(p & 0xFFFFFFFFUL));
+			mi += (c/n) * logl(c*n/(a*b));
+		});
+		s1.for_each([&](uint32_t, uint64_t cnt) {
+			long double c = cnt;
+			p1 += c*(c - 1.0L)/2.0L;
+			h1 -= (c/n) * logl(c/n);
+		});
+		s2.for_each([&](uint32_t, uint64_t cnt) {
+			long double c = cnt;
+			p2 += c*(c - 1.0L)/2.0L;
+			h2 -= (c/n) * logl(c/n);
+		});
+		long double ari = 1.0L, nmi = 1.0L;
+		if(found > 1) {
+			long double expected = p1*p2/(n*(n - 1.0L)/2.0L);
+			long double max = (p1 + p2)/2.0L;
+			if(max != expected) ari = (p12 - expected)/(max - expected);
+		}
+		if(h1 + h2 > 0.0L) nmi = 2.0L*mi/(h1 + h2);
+		long double vi = h1 + h2 - 2.0L*mi;
+		if(vi < 0.0L) vi = 0.0L; /* rounding errors */
+		fprintf(f,"nodes\t%lu\ncomponents1\t%lu\ncomponents2\t%lu\n",found,s1.size(),s2.size());
+		fprintf(f,"ARI\t%.9Lf\nNMI\t%.9Lf\nVI\t%.9Lf\n",ari,nmi,vi);
+	}
+};
+
+
+/* write the changes between the two labelings to f: components are
+ * grouped so that each group contains a set of components in the first
+ * labeling that have the same nodes as a set of components in the second
+ * labeling; groups where this is not one component on each side are
+ * written, as lines of type (M: components of the first labeling merged
+ * into one, S: component split into multiple, X: mixed, i.e. multiple
+ * components on both sides), list of component IDs in the first and in
+ * the second labeling (separated by commas); for mixed groups, one line
+ * is written for each component in the group instead, with the list of
+ * components it overlaps with on the other side
+ * everything except finding the groups is done in parallel on nthreads
+ * threads
+ * returns false on error writing the output */
+bool write_diff(const label_pairs& lp, FILE* f, unsigned int nthreads) {
+	if(nthreads < 1) nthreads = 1;
+	const uint64_t second = 1UL << 32; /* added to IDs in the second labeling */
+	const uint64_t lo = 0xFFFFFFFFUL;
+	union_find<uint64_t> uf;
+	/* all pairs of labels, sorted by the first (p1) and by the second
+	 * label (p2, with the labels swapped), so that each component is
+	 * followed by the components it overlaps with */
+	size_t np = lp.pairs.size();
+	std::vector<uint64_t> p1, p2(np), tmp(np);
+	p1.reserve(np);
+	lp.pairs.for_each([&uf,&p1,second,lo](uint64_t p, uint64_t) {
+		uf.unite(p >> 32,second + (p & lo));
+		p1.push_back(p);
+	});
+	run_threads(nthreads,[&](unsigned int t) {
+		for(size_t i = np*t/nthreads; i < np*(t+1)/nthreads; i++) p2[i] = (p1[i] << 32) | (p1[i] >> 32);
+	});
+	radix_sort64(p1.data(),tmp.data(),np,nthreads);
+	radix_sort64(p2.data(),tmp.data(),np,nthreads);
+	
+	/* start of the range of x processed by thread t, moved forward so
+	 * that elements with the same upper 32 bits are in the same range */
+	auto range_start = [nthreads](const std::vector<uint64_t>& x, unsigned int t) {
+		size_t i = x.size()*t/nthreads;
+		while(i > 0 && i < x.size() && (x[i] >> 32) == (x[i-1] >> 32)) i++;
+		return i;
+	};
+	/* components on one side (from p1 or p2) with their group in the
+	 * upper 32 bits (the root of each group is its smallest component ID
+	 * in the first labeling), sorted by group, then by ID */
+	auto components = [&](const std::vector<uint64_t>& p, uint64_t offset) {
+		std::vector<size_t> cnt(nthreads+1,0);
+		run_threads(nthreads,[&](unsigned int t) {
+			size_t end = range_start(p,t+1);
+			for(size_t i = range_start(p,t); i < end; i++)
+				if(i == 0 || (p[i] >> 32) != (p[i-1] >> 32)) cnt[t+1]++;
+		});
+		for(unsigned int t=0;t<nthreads;t++) cnt[t+1] += cnt[t];
+		std::vector<uint64_t> c(cnt[nthreads]);
+		run_threads(nthreads,[&](unsigned int t) {
+			size_t end = range_start(p,t+1);
+			size_t j = cnt[t];
+			for(size_t i = range_start(p,t); i < end; i++)
+				if(i == 0 || (p[i] >> 32) != (p[i-1] >> 32))
+					c[j++] = (uf.root(offset + (p[i] >> 32)) << 32) | (p[i] >> 32);
+		});
+		radix_sort64(c.data(),tmp.data(),c.size(),nthreads,32);
+		return c;
+	};
+	std::vector<uint64_t> c1 = components(p1,0);
+	std::vector<uint64_t> c2 = components(p2,second);
+	uf.parent.clear();
+	std::vector<uint64_t>().swap(tmp);
+	
+	std::vector<std::string> out(nthreads);
+	std::vector<std::array<uint64_t,4> > cnt(nthreads);
+	run_threads(nthreads,[&](unsigned int t) {
+		std::string& o = out[t];
+		std::array<uint64_t,4>& cn = cnt[t];
+		cn.fill(0);
+		char buf[16];
+		/* write a tab, then the lower 32 bits of [x,end) separated by commas */
+		auto write_ids = [&o,&buf,lo](const uint64_t* x, const uint64_t* end) {
+			for(const uint64_t* y = x; y < end; y++) {
+				o += (y == x) ? '\t' : ',';
+				snprintf(buf,16,"%u",(unsigned int)(*y & lo));
+				o += buf;
+			}
+		};
+		/* write the components that overlap with l (from p1 or p2) */
+		auto write_span = [&write_ids,lo](const std::vector<uint64_t>& p, uint64_t l) {
+			auto x = std::lower_bound(p.begin(),p.end(),l << 32);
+			auto end = std::upper_bound(x,p.end(),(l << 32) | lo);
+			write_ids(p.data() + (x - p.begin()),p.data() + (end - p.begin()));
+		};
+		size_t i = range_start(c1,t);
+		size_t end = range_start(c1,t+1);
+		if(i >= end) return;
+		size_t j = std::lower_bound(c2.begin(),c2.end(),c1[i] & ~lo) - c2.begin();
+		while(i < end) {
+			uint64_t g = c1[i] >> 32;
+			size_t i2 = i, j2 = j;
+			while(i2 < end && (c1[i2] >> 32) == g) i2++;
+			while(j2 < c2.size() && (c2[j2] >> 32) == g) j2++;
+			size_t a = i2 - i, b = j2 - j;
+			if(a == 1 && b == 1) cn[0]++;
+			else if(a == 1 || b == 1) {
+				if(b == 1) { o += 'M'; cn[1]++; }
+				else { o += 'S'; cn[2]++; }
+				write_ids(c1.data() + i,c1.data() + i2);
+				write_ids(c2.data() + j,c2.data() + j2);
+				o += '\n';
+			}
+			else {
+				cn[3]++;
+				for(size_t k=i;k<i2;k++) {
+					o += 'X';
+					write_ids(c1.data() + k,c1.data() + k + 1);
+					write_span(p1,c1[k] & lo);
+					o += '\n';
+				}
+				for(size_t k=j;k<j2;k++) {
+					o += 'X';
+					write_span(p2,c2[k] & lo);
+					write_ids(c2.data() + k,c2.data() + k + 1);
+					o += '\n';
+				}
+			}
+			i = i2;
+			j = j2;
+		}
+	});
+	bool ret = true;
+	for(const auto& o : out) if(o.size() && fwrite(o.data(),1,o.size(),f) != o.size()) ret = false;
+	std::array<uint64_t,4> total = {0,0,0,0};
+	for(const auto& cn : cnt) for(int i=0;i<4;i++) total[i] += cn[i];
+	time_t t1 = time(0);
+	fprintf(stderr,"%s%lu components unchanged, %lu merged, %lu split, %lu mixed groups\n",
+		ctime(&t1),total[0],total[1],total[2],total[3]);
+	return ret;
+}
+
+
+/* options for the comparison and the outputs to write after it (besides
+ * the differences found) */
+struct compare_options {
+	bool similarity; /* write similarity measures to stdout */
+	const char* difffn; /* write the changed components to this file */
+	unsigned int nthreads; /* number of threads to use */
+	bool binary; /* input files are in binary format */
+	compare_options() : similarity(false),difffn(0),nthreads(1),binary(false) { }
+};
+
+/* write the results of a comparison, n1 is the number of nodes in the
+ * first labeling
+ * returns 0 if no difference was found */
+int finish(const label_pairs& lp, uint64_t n1, const compare_options& opts) {
+	int ret = lp.report(n1) ? 0 : 1;
+	if(opts.similarity) lp.write_similarity(stdout);
+	if(opts.difffn) {
+		FILE* f = fopen(opts.difffn,"w");
+		if(!f) {
+			fprintf(stderr,"Error opening output file %s!\n",opts.difffn);
+			return 2;
+		}
+		if(!write_diff(lp,f,opts.nthreads) || fclose(f)) {
+			fprintf(stderr,"Error writing output file %s!\n",opts.difffn);
+			return 2;
+		}
+	}
+	return ret;
+}
+
+
+/* reorder the (node, label) pairs in a so that nodes are grouped into
+ * nparts partitions by their hash; partition i will be in the range
+ * [start[i],start[i+1]) -- each thread counts the elements for each
+ * partition in its part of a, then copies them to their place, so the
+ * original order is kept within each partition */
+void partition_ids(std::vector<uint64_t>& a, std::vector<size_t>& start, unsigned int nparts) {
+	ch32 h;
+	size_t n = a.size();
+	std::vector<size_t> cnt(nparts*nparts,0);
+	run_threads(nparts,[&](unsigned int t) {
+		size_t* c = cnt.data() + t*nparts;
+		for(size_t i = n*t/nparts; i < n*(t+1)/nparts; i++) c[h(a[i] >> 32) % nparts]++;
+	});
+	/* offset for each partition and thread: all previous partitions,
+	 * then the same partition in previous threads */
+	start.resize(nparts+1);
+	size_t sum = 0;
+	for(unsigned int p=0;p<nparts;p++) {
+		start[p] = sum;
+		for(unsigned int t=0;t<nparts;t++) {
+			size_t c = cnt[t*nparts + p];
+			cnt[t*nparts + p] = sum;
+			sum += c;
+		}
+	}
+	start[nparts] = sum;
+	std::vector<uint64_t> b(n);
+	run_threads(nparts,[&](unsigned int t) {
+		size_t* c = cnt.data() + t*nparts;
+		for(size_t i = n*t/nparts; i < n*(t+1)/nparts; i++) b[c[h(a[i] >> 32) % nparts]++] = a[i];
+	});
+	a.swap(b);
+}
+
+/* linear time comparison using hash maps: the first labeling is stored
+ * as a node -> label map, the second one is streamed, while counting the
+ * pairs of labels found
+ * with multiple threads, both files are loaded in parallel, then nodes
+ * are partitioned by their hash (in one pass over each), and the
+ * partitions are processed in parallel; the pairs of labels found in
+ * each are merged at the end
+ * returns 0 if no difference was found */
+int compare_hash(const char* fn1, const char* fn2, uint64_t n1, const compare_options& opts) {
+	unsigned int nthreads = opts.nthreads;
+	if(!n1 && !opts.binary) n1 = count_lines(fn1);
+	if(nthreads <= 1) {
+		flat_map<uint32_t> m1(n1);
+		bool dup = false;
+		if(read_sccs_f(fn1,opts.binary,[&m1,&dup](unsigned int x, unsigned int y) {
+				if(m1.insert(x,y).second) return true;
+				fprintf(stderr,"ID %u found multiple times in the first dataset!\n",x);
+				dup = true;
+				return false;
+			}) || dup) return 1;
+		label_pairs lp;
+		if(read_sccs_f(fn2,opts.binary,[&m1,&lp](unsigned int x, unsigned int y) {
+				const uint32_t* l1 = m1.find(x);
+				if(l1) lp.add(*l1,y);
+				else lp.add_missing(x);
+				return true;
+			})) return 1;
+		return finish(lp,m1.size(),opts);
+	}
+	
+	/* parallel version: load both files, partition the nodes by their
+	 * hash, then each thread processes the nodes in its partition */
+	std::vector<uint64_t> sccs1, sccs2;
+	if(load_both(fn1,fn2,opts.binary,sccs1,sccs2,n1,nthreads)) return 1;
+	std::vector<size_t> start1, start2;
+	partition_ids(sccs1,start1,nthreads);
+	partition_ids(sccs2,start2,nthreads);
+	std::vector<label_pairs> lp(nthreads);
+	std::vector<int> dup(nthreads,0);
+	std::vector<unsigned int> dup_id(nthreads);
+	std::vector<uint64_t> size1(nthreads,0);
+	run_threads(nthreads,[&](unsigned int i) {
+		flat_map<uint32_t> m1(start1[i+1] - start1[i]);
+		for(size_t j = start1[i]; j < start1[i+1]; j++) {
+			uint64_t x = sccs1[j];
+			if(!m1.insert(x >> 32,x & 0xFFFFFFFFUL).second && !dup[i]) {
+				dup[i] = 1;
+				dup_id[i] = x >> 32;
+			}
+		}
+		if(dup[i]) return;
+		size1[i] = m1.size();
+		for(size_t j = start2[i]; j < start2[i+1]; j++) {
+			uint64_t x = sccs2[j];
+			const uint32_t* l1 = m1.find(x >> 32);
+			if(l1) lp[i].add(*l1,x & 0xFFFFFFFFUL);
+			else lp[i].add_missing(x >> 32);
+		}
+	});
+	for(unsigned int i=0;i<nthreads;i++) if(dup[i]) {
+		fprintf(stderr,"ID %u found multiple times in the first dataset!\n",dup_id[i]);
+		return 1;
+	}
+	std::vector<uint64_t>().swap(sccs1);
+	std::vector<uint64_t>().swap(sccs2);
+	n1 = 0;
+	for(unsigned int i=0;i<nthreads;i++) n1 += size1[i];
+	for(unsigned int i=1;i<nthreads;i++) {
+		lp[0].merge(lp[i]);
+		lp[i].pairs.clear();
+	}
+	return finish(lp[0],n1,opts);
+}
+
+/* temporary file for one bucket in the out-of-core comparison, deleted
+ * immediately after creating it */
+static FILE* bucket_file(const char* tmpdir) {
+	std::vector<char> fn(strlen(tmpdir) + 32);
+	sprintf(fn.data(),"%s/sccscompXXXXXX",tmpdir);
+	int fd = mkstemp(fn.data());
+	if(fd == -1) return 0;
+	unlink(fn.data());
+	FILE* f = fdopen(fd,"w+");
+	if(!f) {
+		int err = errno;
+		close(fd);
+		errno = err;
+	}
+	return f;
+}
+
+/* maximum number of buckets that can be open at the same time (with two
+ * files for each) -- this is limited by the number of open files (the
+ * soft limit is raised to the hard limit if possible, some files are
+ * left for other uses), and by the memory used by the buffers of the
+ * files, which should not exceed mem */
+static size_t max_open_buckets(uint64_t mem) {
+	const uint64_t reserved = 32;
+	uint64_t n = 1024;
+	struct rlimit rl;
+	if(!getrlimit(RLIMIT_NOFILE,&rl)) {
+		if(rl.rlim_cur < rl.rlim_max) {
+			struct rlimit rl2 = rl;
+			rl2.rlim_cur = rl.rlim_max;
+			if(!setrlimit(RLIMIT_NOFILE,&rl2)) rl = rl2;
+		}
+		n = (rl.rlim_cur == RLIM_INFINITY) ? (1UL << 20) : rl.rlim_cur;
+	}
+	n = (n > reserved + 2) ? (n - reserved) / 2 : 1;
+	uint64_t n2 = mem / (2*BUFSIZ);
+	if(n2 < n) n = n2;
+	return n ? n : 1;
+}
+
+/* out-of-core comparison: both files are partitioned into nb buckets by
+ * the hash of node IDs (stored as temporary files in tmpdir), then each
+ * bucket is compared separately using a hash map; only the pairs of
+ * labels found (and the maps for one bucket) are kept in memory
+ * mem is the memory to use for one bucket (in bytes) -- this determines
+ * the number of buckets; if not all buckets can be open at the same time,
+ * this is done in multiple passes, each reading both files and creating
+ * and comparing only some of the buckets
+ * returns 0 if no difference was found */
+int compare_external(const char* fn1, const char* fn2, uint64_t n1, uint64_t mem, const char* tmpdir, const compare_options& opts) {
+	if(!n1 && opts.binary) {
+		mapped_file m;
+		if(fn1 && m.open(fn1)) n1 = m.len / (2*sizeof(uint32_t));
+	}
+	if(!n1) n1 = count_lines(fn1);
+	if(!n1) {
+		fprintf(stderr,"Number of lines in the first file is not known, use the -N option!\n");
+		return 1;
+	}
+	/* the hash map for a bucket uses at most 32 bytes per node (8 bytes
+	 * per slot, at most 4 slots per node), plus the buffer for reading
+	 * the bucket */
+	const uint64_t bytes_per_node = 32 + sizeof(uint64_t);
+	size_t nb = (n1*bytes_per_node + mem - 1) / mem;
+	if(nb < 1) nb = 1;
+	size_t nopen = max_open_buckets(mem);
+	if(nopen > nb) nopen = nb;
+	size_t npass = (nb + nopen - 1) / nopen;
+	time_t t1 = time(0);
+	fprintf(stderr,"%susing %lu buckets in %lu passes\n",ctime(&t1),nb,npass);
+	if(npass > 1 && !(fn1 && fn2)) {
+		fprintf(stderr,"Error: input files are read multiple times, these cannot be read from stdin!\n");
+		return 1;
+	}
+	
+	/* note: uses a different hash than flat_map, so that nodes in one
+	 * bucket are distributed evenly there */
+	ch64 h;
+	label_pairs lp;
+	uint64_t n1_found = 0;
+	std::vector<uint64_t> buf;
+	std::vector<FILE*> b1(nopen,0);
+	std::vector<FILE*> b2(nopen,0);
+	int ret = 0; /* 1: error reading temporary files, 2: duplicate IDs, 3: other errors */
+	for(size_t pass = 0; pass < npass && !ret; pass++) {
+		/* buckets in this pass */
+		size_t first = pass*nopen;
+		size_t k = std::min(nopen,nb - first);
+		for(size_t i=0;i<k;i++) {
+			b1[i] = bucket_file(tmpdir);
+			b2[i] = bucket_file(tmpdir);
+			if(!b1[i] || !b2[i]) {
+				fprintf(stderr,"Error creating temporary files in %s: %s!\n",tmpdir,strerror(errno));
+				ret = 3;
+				break;
+			}
+		}
+		
+		/* partition both files, keeping the nodes in the current buckets */
+		bool werr = false;
+		auto partition = [&h,nb,first,k,&werr](std::vector<FILE*>& b) {
+			return [&h,nb,first,k,&werr,&b](unsigned int x, unsigned int y) {
+				size_t i = h(x) % nb - first; /* note: wraps around for earlier buckets */
+				if(i >= k) return true;
+				uint64_t tmp = (((uint64_t)x) << 32) | y;
+				if(fwrite(&tmp,sizeof(uint64_t),1,b[i]) != 1) { werr = true; return false; }
+				return true;
+			};
+		};
+		if(!ret && (read_sccs_f(fn1,opts.binary,partition(b1)) || read_sccs_f(fn2,opts.binary,partition(b2)) || werr)) {
+			if(werr) fprintf(stderr,"Error writing temporary files: %s!\n",strerror(errno));
+			ret = 3;
+		}
+		if(!ret) {
+			t1 = time(0);
+			fprintf(stderr,"%sinput files partitioned (pass %lu / %lu)\n",ctime(&t1),pass+1,npass);
+		}
+		
+		/* compare each bucket */
+		for(size_t i=0;i<k && !ret;i++) {
+			flat_map<uint32_t> m1;
+			for(int j=0;j<2 && !ret;j++) {
+				FILE* f = j ? b2[i] : b1[i];
+				if(fflush(f) || fseek(f,0,SEEK_END)) { ret = 1; break; }
+				size_t n = ftell(f) / sizeof(uint64_t);
+				rewind(f);
+				buf.resize(n);
+				if(fread(buf.data(),sizeof(uint64_t),n,f) != n) { ret = 1; break; }
+				if(j == 0) {
+					m1.reserve(n);
+					for(uint64_t x : buf) if(!m1.insert(x >> 32,x & 0xFFFFFFFFUL).second) {
+						fprintf(stderr,"ID %u found multiple times in the first dataset!\n",(unsigned int)(x >> 32));
+						ret = 2;
+						break;
+					}
+					n1_found += m1.size();
+				}
+				else for(uint64_t x : buf) {
+					const uint32_t* l1 = m1.find(x >> 32);
+					if(l1) lp.add(*l1,x & 0xFFFFFFFFUL);
+					else lp.add_missing(x >> 32);
+				}
+			}
+		}
+		if(ret == 1) fprintf(stderr,"Error reading temporary files!\n");
+		for(size_t i=0;i<k;i++) {
+			if(b1[i]) fclose(b1[i]);
+			if(b2[i]) fclose(b2[i]);
+			b1[i] = 0;
+			b2[i] = 0;
+		}
+	}
+	if(ret) return 1;
+	return finish(lp,n1_found,opts);
+}
+
+
+/* check a labeling (in fn1) directly against the edges of the graph (in
+ * efn) in one pass over the edges:
+ *   -- edges between nodes with different labels mean that these labels
+ *     should have been merged (these are tracked with union-find to count
+ *     the correct number of components)
+ *   -- union-find over nodes, using edges inside labels, shows if any
+ *     label contains nodes that are not connected (i.e. should be split)
+ * returns 0 if the labeling is correct */
+int check_edges(const char* fn1, const char* efn, uint64_t n1, bool binary) {
+	if(!n1 && !binary) n1 = count_lines(fn1);
+	std::vector<uint32_t> labels;
+	flat_map<uint32_t> idx(n1); /* node ID -> index in labels */
+	labels.reserve(n1);
+	bool dup = false;
+	if(read_sccs_f(fn1,binary,[&labels,&idx,&dup](unsigned int x, unsigned int y) {
+			if(!idx.insert(x,labels.size()).second) {
+				fprintf(stderr,"ID %u found multiple times in the labeling!\n",x);
+				dup = true;
+				return false;
+			}
+			labels.push_back(y);
+			return true;
+		}) || dup) return 1;
+	if(labels.size() >= (1UL << 32)) {
+		fprintf(stderr,"Too many nodes in the labeling!\n");
+		return 1;
+	}
+	
+	/* union-find over node indices (root is the smallest index) */
+	std::vector<uint32_t> parent(labels.size());
+	for(size_t i=0;i<parent.size();i++) parent[i] = i;
+	auto find = [&parent](uint32_t x) {
+		while(parent[x] != x) {
+			parent[x] = parent[parent[x]];
+			x = parent[x];
+		}
+		return x;
+	};
+	union_find<uint32_t> merges; /* labels that should be merged */
+	uint64_t nedges = 0, cross = 0, missing = 0;
+	
+	read_table2 rt(efn);
 	while(rt.read_line()) {
-		unsigned int x,y;
-		if(!rt.read(x,y)) break;
-		sccs.push_back(std::make_pair(x,y));
+		uint32_t u, v;
+		if(!rt.read(u,v)) {
+			if(rt.get_last_error() == T_OVERFLOW) continue; /* ignore negative IDs (same as sccs32s) */
+			break;
+		}
+		nedges++;
+		const uint32_t* i = idx.find(u);
+		const uint32_t* j = idx.find(v);
+		if(!i || !j) { missing++; continue; }
+		if(labels[*i] != labels[*j]) {
+			cross++;
+			merges.unite(labels[*i],labels[*j]);
+		}
+		else {
+			uint32_t r1 = find(*i);
+			uint32_t r2 = find(*j);
+			if(r1 < r2) parent[r2] = r1;
+			else if(r2 < r1) parent[r1] = r2;
+		}
 	}
-	if(fn) fclose(f1);
 	if(rt.get_last_error() != T_EOF) {
 		fprintf(stderr,"Error reading input: ");
 		rt.write_error(stderr);
 		return 1;
 	}
-	return 0;
+	
+	/* check that all nodes with the same label are in one set */
+	flat_map<uint32_t> roots; /* label -> root of its first node */
+	flat_map<uint32_t> split; /* labels found to be split */
+	uint64_t split_nodes = 0;
+	for(size_t i=0;i<labels.size();i++) {
+		uint32_t r = find(i);
+		auto x = roots.insert(labels[i],r);
+		if(!x.second && *(x.first) != r) {
+			split.insert(labels[i],0);
+			if(r == i) split_nodes++; /* count the extra sets in this label */
+		}
+	}
+	
+	time_t t1 = time(0);
+	fprintf(stderr,"%s%lu edges, %lu nodes, %lu components checked\n",ctime(&t1),nedges,labels.size(),roots.size());
+	uint64_t nmerges = 0;
+	for(const auto& x : merges.parent) if(x.first != x.second) nmerges++;
+	if(missing) fprintf(stderr,"%lu edges contain nodes not in the labeling!\n",missing);
+	if(cross) fprintf(stderr,"%lu edges are between different components "
+		"(%lu components should be merged into %lu)!\n",cross,merges.size(),merges.size() - nmerges);
+	if(split.size()) fprintf(stderr,"%lu components are not connected "
+		"(should be split into %lu more components)!\n",split.size(),split_nodes);
+	return (missing || cross || split.size()) ? 1 : 0;
 }
 
+
 int main(int argc, char **argv)
 {
 	char* i1 = 0;
 	char* i2 = 0;
+	bool use_hash = false;
+	unsigned int nthreads = 1;
+	uint64_t n1 = 0; /* number of lines in the first file, if known */
+	char* tmpfn = 0; /* temporary file to use as the buffer for sorting */
+	uint64_t mem = 0; /* memory to use in out-of-core mode (in MB) */
+	const char* tmpdir = "."; /* directory for temporary files in out-of-core mode */
+	compare_options opts;
+	char* edgefn = 0; /* check the labeling in the first file against these edges */
 	
 	for(int i=1;i<argc;i++) if(argv[i][0] == '-') switch(argv[i][1]) {
 		case '1':
@@ -81,6 +912,36 @@ int main(int argc, char **argv)
 				i2 = argv[i+1];
 			}
 			break;
+		case 'h': /* use hash maps instead of sorting */
+			use_hash = true;
+			break;
+		case 'P': /* number of threads to use */
+			nthreads = strtoul(argv[i+1],0,10);
+			break;
+		case 'N': /* number of lines in the first file (to reserve memory in advance) */
+			n1 = strtoul(argv[i+1],0,10);
+			break;
+		case 't': /* temporary file for sorting */
+			tmpfn = argv[i+1];
+			break;
+		case 'M': /* out-of-core comparison, using about this much memory (in MB) */
+			mem = strtoul(argv[i+1],0,10);
+			break;
+		case 'T': /* directory for temporary files in out-of-core mode */
+			tmpdir = argv[i+1];
+			break;
+		case 's': /* write similarity measures (ARI, NMI, VI) to stdout */
+			opts.similarity = true;
+			break;
+		case 'd': /* write the list of merged / split components to a file */
+			opts.difffn = argv[i+1];
+			break;
+		case 'e': /* check the first file against this edge list */
+			edgefn = argv[i+1];
+			break;
+		case 'b': /* input files are in binary format */
+			opts.binary = true;
+			break;
 		default:
 			fprintf(stderr,"Unknown parameter: %s!\n",argv[i]);
 			break;
@@ -90,45 +951,58 @@ int main(int argc, char **argv)
 		fprintf(stderr,"No input files given!\n");
 		return 1;
 	}
+	opts.nthreads = nthreads;
 	
-	std::vector<std::pair<unsigned int,unsigned int> > sccs1;
-	std::vector<std::pair<unsigned int,unsigned int> > sccs2;
+	if(edgefn) return check_edges(i1,edgefn,n1,opts.binary);
 	
-	if(read_sccs(i1,sccs1) || read_sccs(i2,sccs2)) return 1;
+	if(mem) return compare_external(i1,i2,n1,mem << 20,tmpdir,opts);
+	if(use_hash) return compare_hash(i1,i2,n1,opts);
+	
+	/* with multiple threads, load both files in parallel, otherwise only
+	 * the first one is stored in memory */
+	std::vector<uint64_t> sccs1, sccs2;
+	if(nthreads > 1) {
+		if(load_both(i1,i2,opts.binary,sccs1,sccs2,n1,nthreads)) return 1;
+	}
+	else if(read_sccs(i1,opts.binary,sccs1,n1)) return 1;
 	
 	/* sort first list by addresses */
-	std::sort(sccs1.begin(),sccs1.end(),[](const auto& a, const auto& b) { return a.first < b.first; });
-	/* sort second list by sccs IDs */
-	std::sort(sccs2.begin(),sccs2.end(),[](const auto& a, const auto& b) { return a.second < b.second; });
-	
-	unsigned int sccid2 = sccs2[0].second + 1; /* make sure it will not match */
-	unsigned int sccid1 = 0;
-	for(const auto& x : sccs2) {
-		/* find address in sccs1
-		 * note: total runtime will be ~N*log(N) because of the binary search
-		 * could be faster using hashmaps
-		 * but the above sort already need ~N*log(N) time, so this will not
-		 * be significant */
-		const auto y = std::lower_bound(sccs1.begin(),sccs1.end(),x.first,
-			[](const auto& a, const auto& b) { return a.first < b; });
-		if( !(y < sccs1.end()) || y->first != x.first ) {
-			fprintf(stderr,"ID %u not found in the first dataset!\n",x.first);
-			break;
-		}
-		if(x.second != sccid2) {
-			/* new SCC, nothing to compare yet
-			 * note: this should ensure that y->second is a new unique sccid,
-			 * but currently does not do that
-			 * the solution for that is to run the whole program both ways */
-			sccid1 = y->second;
-			sccid2 = x.second;
-		}
-		else if(y->second != sccid1) {
-			fprintf(stderr,"Mismatch for address %u!\n",x.first);
-			break;
+	{
+		sccs_buffer tmp;
+		if(sccs1.size() && tmp.alloc(sccs1.size()*sizeof(uint64_t),tmpfn)) return 1;
+		radix_sort64(sccs1.data(),(uint64_t*)tmp.buf,sccs1.size(),nthreads,32);
+	}
+	for(size_t i=1;i<sccs1.size();i++) if((sccs1[i] >> 32) == (sccs1[i-1] >> 32)) {
+		fprintf(stderr,"ID %u found multiple times in the first dataset!\n",(unsigned int)(sccs1[i] >> 32));
+		return 1;
+	}
+	
+	/* find each node of the second list in the first one, keep track of
+	 * the pairs of component IDs found -- this checks the mapping of
+	 * components in both directions */
+	auto lookup = [&sccs1](label_pairs& lp, unsigned int x, unsigned int y) {
+		/* note: total runtime will be ~N*log(N) because of the binary search
+		 * could be faster using hashmaps (see the -h option) */
+		const auto it = std::lower_bound(sccs1.begin(),sccs1.end(),((uint64_t)x) << 32);
+		if(it == sccs1.end() || ((*it) >> 32) != x) lp.add_missing(x);
+		else lp.add((unsigned int)(*it & 0xFFFFFFFFUL),y);
+	};
+	std::vector<label_pairs> lp(nthreads > 1 ? nthreads : 1);
+	if(nthreads > 1) {
+		run_threads(nthreads,[&](unsigned int t) {
+			for(size_t i = sccs2.size()*t/nthreads; i < sccs2.size()*(t+1)/nthreads; i++)
+				lookup(lp[t],sccs2[i] >> 32,sccs2[i] & 0xFFFFFFFFUL);
+		});
+		for(unsigned int t=1;t<nthreads;t++) {
+			lp[0].merge(lp[t]);
+			lp[t].pairs.clear();
 		}
 	}
+	else if(read_sccs_f(i2,opts.binary,[&lookup,&lp](unsigned int x, unsigned int y) {
+			lookup(lp[0],x,y);
+			return true;
+		})) return 1;
 	
-	return 0;
+	return finish(lp[0],sccs1.size(),opts);
 }
 
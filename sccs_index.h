@@ -0,0 +1,228 @@
+/*
+ * sccs_index.h -- persistent index of connected components (node ID ->
+ * 	component ID) that can be memory mapped for fast lookups
+ *
+ * format of the index file (all numbers in native byte order):
+ *   -- header: 8 bytes magic ("SCCSIDX" and a version byte), 64-bit
+ *     number of nodes (n)
+ *   -- table of 2^16 + 1 64-bit offsets: nodes are grouped into 2^16
+ *     buckets by the upper 16 bits of their ID, nodes in bucket b are
+ *     stored between offsets b and b+1
+ *   -- n 32-bit node IDs, sorted
+ *   -- n 32-bit component IDs (in the same order as the node IDs)
+ * lookup of a node is a binary search in its bucket (i.e. among ~n / 2^16
+ * elements)
+ *
+ * Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _SCCS_INDEX_H
+#define _SCCS_INDEX_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+/* use POSIX functions for memory management */
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+static const char sccs_index_magic[8] = {'S','C','C','S','I','D','X',1};
+static const unsigned int sccs_index_shift = 16;
+static const size_t sccs_index_buckets = 1UL << (32 - sccs_index_shift);
+
+struct sccs_index_header {
+	char magic[8];
+	uint64_t n;
+};
+
+static inline size_t sccs_index_size(uint64_t n) {
+	return sizeof(sccs_index_header) + (sccs_index_buckets + 1)*sizeof(uint64_t) +
+		2*n*sizeof(uint32_t);
+}
+
+/* write an index to the given file; gen is a function that calls its
+ * argument as f(node,label) for all nodes and returns true on success --
+ * it is called twice (first to count the nodes in each bucket, then to
+ * store them), so it should give the same nodes both times
+ * returns true on success */
+template<class G>
+bool sccs_index_write(const char* fn, G&& gen) {
+	std::vector<uint64_t> pos(sccs_index_buckets + 1,0);
+	/* 1. count nodes in each bucket */
+	if(!gen([&pos](uint32_t x, uint32_t) { pos[(x >> sccs_index_shift) + 1]++; })) return false;
+	for(size_t i=1;i<=sccs_index_buckets;i++) pos[i] += pos[i-1];
+	uint64_t n = pos[sccs_index_buckets];
+	size_t s = sccs_index_size(n);
+
+	/* 2. create the output file and map it to memory */
+	int fd = open(fn,O_CREAT | O_RDWR | O_TRUNC,S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if(fd == -1) {
+		fprintf(stderr,"Error opening index file %s!\n",fn);
+		return false;
+	}
+	if(ftruncate(fd,s) == -1) {
+		fprintf(stderr,"Error setting file size on index file %s to %lu!\n",fn,s);
+		close(fd);
+		return false;
+	}
+	void* buf = mmap(0,s,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+	if(buf == MAP_FAILED) {
+		fprintf(stderr,"Error mapping index file %s!\n",fn);
+		close(fd);
+		return false;
+	}
+	sccs_index_header* h = (sccs_index_header*)buf;
+	memcpy(h->magic,sccs_index_magic,sizeof(sccs_index_magic));
+	h->n = n;
+	uint64_t* table = (uint64_t*)(h + 1);
+	uint32_t* keys = (uint32_t*)(table + sccs_index_buckets + 1);
+	uint32_t* labels = keys + n;
+	std::copy(pos.begin(),pos.end(),table);
+
+	/* 3. store all nodes in their bucket, then sort each bucket */
+	bool ret = gen([&pos,keys,labels,n](uint32_t x, uint32_t l) {
+		uint64_t i = pos[x >> sccs_index_shift]++;
+		if(i < n) { keys[i] = x; labels[i] = l; }
+	});
+	for(size_t i=0;i<sccs_index_buckets && ret;i++) if(pos[i] != table[i+1]) {
+		fprintf(stderr,"sccs_index_write(): inconsistent input!\n");
+		ret = false;
+	}
+	if(ret) {
+		std::vector<uint64_t> tmp;
+		for(size_t i=0;i<sccs_index_buckets;i++) {
+			tmp.clear();
+			for(uint64_t j=table[i];j<table[i+1];j++)
+				tmp.push_back( ((uint64_t)keys[j]) << 32 | labels[j] );
+			std::sort(tmp.begin(),tmp.end());
+			for(uint64_t j=table[i];j<table[i+1];j++) {
+				keys[j] = tmp[j - table[i]] >> 32;
+				labels[j] = tmp[j - table[i]];
+			}
+		}
+	}
+	munmap(buf,s);
+	close(fd);
+	return ret;
+}
+
+
+/* read-only access to an index file */
+struct sccs_index {
+	protected:
+		void* buf;
+		size_t s;
+		uint64_t n;
+		const uint64_t* table;
+		const uint32_t* keys;
+		const uint32_t* labels;
+	public:
+		sccs_index() : buf(MAP_FAILED),s(0),n(0),table(0),keys(0),labels(0) { }
+		~sccs_index() { close(); }
+		sccs_index(const sccs_index&) = delete;
+		sccs_index& operator = (const sccs_index&) = delete;
+
+		/* open and map the given index file; if populate == true, the
+		 * whole file is read into memory in advance
+		 * returns true on success */
+		bool open(const char* fn, bool populate = false) {
+			close();
+			int fd = ::open(fn,O_RDONLY);
+			if(fd == -1) {
+				fprintf(stderr,"Error opening index file %s!\n",fn);
+				return false;
+			}
+			struct stat st;
+			if(fstat(fd,&st) == -1 || (size_t)st.st_size < sccs_index_size(0)) {
+				fprintf(stderr,"Invalid index file %s!\n",fn);
+				::close(fd);
+				return false;
+			}
+			s = st.st_size;
+			buf = mmap(0,s,PROT_READ,MAP_SHARED | (populate ? MAP_POPULATE : 0),fd,0);
+			::close(fd);
+			if(buf == MAP_FAILED) {
+				fprintf(stderr,"Error mapping index file %s!\n",fn);
+				return false;
+			}
+			const sccs_index_header* h = (const sccs_index_header*)buf;
+			if(memcmp(h->magic,sccs_index_magic,sizeof(sccs_index_magic)) ||
+					sccs_index_size(h->n) != s) {
+				fprintf(stderr,"Invalid index file %s!\n",fn);
+				close();
+				return false;
+			}
+			n = h->n;
+			table = (const uint64_t*)(h + 1);
+			keys = (const uint32_t*)(table + sccs_index_buckets + 1);
+			labels = keys + n;
+			if(!populate) madvise(buf,s,MADV_RANDOM);
+			return true;
+		}
+		void close() {
+			if(buf != MAP_FAILED) munmap(buf,s);
+			buf = MAP_FAILED;
+			s = 0;
+			n = 0;
+		}
+
+		/* number of nodes in the index */
+		uint64_t size() const { return n; }
+
+		/* find the component ID of node x; returns false if it is not found */
+		bool find(uint32_t x, uint32_t& l) const {
+			if(!n) return false;
+			size_t b = x >> sccs_index_shift;
+			const uint32_t* k1 = keys + table[b];
+			const uint32_t* k2 = keys + table[b+1];
+			const uint32_t* k = std::lower_bound(k1,k2,x);
+			if(k == k2 || *k != x) return false;
+			l = labels[k - keys];
+			return true;
+		}
+
+		/* check if two nodes are in the same component
+		 * note: nodes not found are only connected to themselves */
+		bool connected(uint32_t x, uint32_t y) const {
+			if(x == y) return true;
+			uint32_t l1, l2;
+			if(!find(x,l1) || !find(y,l2)) return false;
+			return l1 == l2;
+		}
+};
+
+#endif /* _SCCS_INDEX_H */
+
@@ -0,0 +1,97 @@
+/*
+ * sccs_lookup.cpp -- look up the components of nodes in an index created
+ * 	by sccs32s (with the -x option)
+ *
+ * reads node IDs from the standard input (one per line) and writes them
+ * with their component ID; nodes not in the index are written with -1
+ *
+ * with the -c option, pairs of node IDs are read instead and written out
+ * with 1 or 0 depending on whether they are in the same component
+ *
+ * Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include "read_table.h"
+#include "sccs_index.h"
+
+int main(int argc, char **argv)
+{
+	char* fn = 0;
+	bool pairs = false;
+	bool populate = false;
+
+	for(int i=1;i<argc;i++) if(argv[i][0] == '-') switch(argv[i][1]) {
+		case 'x': /* index file to use, need to be given */
+			fn = argv[i+1];
+			break;
+		case 'c': /* read pairs of nodes and check if they are connected */
+			pairs = true;
+			break;
+		case 'p': /* read the whole index into memory before starting */
+			populate = true;
+			break;
+		default:
+			fprintf(stderr,"Unknown parameter: %s!\n",argv[i]);
+			break;
+	}
+
+	if(fn == 0) {
+		fprintf(stderr,"Error: no index file given!\n");
+		return 1;
+	}
+
+	sccs_index idx;
+	if(!idx.open(fn,populate)) return 1;
+
+	read_table2 r(stdin);
+	while(r.read_line()) {
+		uint32_t x, y, l;
+		if(pairs) {
+			if(!r.read(x,y)) break;
+			fprintf(stdout,"%u\t%u\t%d\n",x,y,idx.connected(x,y) ? 1 : 0);
+		}
+		else {
+			if(!r.read(x)) break;
+			if(idx.find(x,l)) fprintf(stdout,"%u\t%u\n",x,l);
+			else fprintf(stdout,"%u\t-1\n",x);
+		}
+	}
+	if(r.get_last_error() != T_EOF) {
+		fprintf(stderr,"Error reading input: ");
+		r.write_error(stderr);
+		return 1;
+	}
+
+	return 0;
+}
+
@@ -0,0 +1,169 @@
+/*
+ * sccs_python.cpp -- Python extension module (_sccs) for the connected
+ * 	components library, using the C interface in sccs_capi.h
+ *
+ * arrays are accepted through the buffer protocol, so NumPy arrays (of type
+ * uint32, C-contiguous) are used without copying; the GIL is released
+ * during the calculations; see sccs.py for the Python interface
+ *
+ * Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <string.h>
+#include "sccs_capi.h"
+
+/* get a buffer of 32-bit unsigned integers from a Python object
+ * returns false (with an exception set) on error */
+static bool get_buffer(PyObject* o, Py_buffer* b, bool writable, const char* name) {
+	if(PyObject_GetBuffer(o,b,PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0))) return false;
+	/* note: "I" and "=I" are both uint32 on all relevant platforms */
+	const char* f = b->format;
+	if(f && (f[0] == '=' || f[0] == '<' || f[0] == '@')) f++;
+	if(b->itemsize != 4 || !f || !(strcmp(f,"I") == 0 || (strcmp(f,"L") == 0 && sizeof(long) == 4))) {
+		PyErr_Format(PyExc_TypeError,"%s: array of 32-bit unsigned integers (uint32) expected",name);
+		PyBuffer_Release(b);
+		return false;
+	}
+	return true;
+}
+
+/* edge_labels(u, v, out, engine) -- component of each edge in out */
+static PyObject* sccs_edge_labels(PyObject* self, PyObject* args) {
+	PyObject *ou, *ov, *oo;
+	int engine = SCCS_ENGINE_UNION_FIND;
+	if(!PyArg_ParseTuple(args,"OOO|i",&ou,&ov,&oo,&engine)) return 0;
+	Py_buffer u, v, o;
+	if(!get_buffer(ou,&u,false,"u")) return 0;
+	if(!get_buffer(ov,&v,false,"v")) { PyBuffer_Release(&u); return 0; }
+	if(!get_buffer(oo,&o,true,"out")) { PyBuffer_Release(&u); PyBuffer_Release(&v); return 0; }
+	int ret = -1;
+	size_t n = u.len / 4;
+	if(v.len == u.len && o.len == u.len) {
+		Py_BEGIN_ALLOW_THREADS
+		ret = sccs_compute((const uint32_t*)u.buf,(const uint32_t*)v.buf,n,(uint32_t*)o.buf,engine);
+		Py_END_ALLOW_THREADS
+	}
+	PyBuffer_Release(&u);
+	PyBuffer_Release(&v);
+	PyBuffer_Release(&o);
+	if(ret < 0) { PyErr_SetString(PyExc_ValueError,"u, v and out must have the same length"); return 0; }
+	if(ret) { PyErr_SetString(PyExc_RuntimeError,"error calculating components"); return 0; }
+	Py_RETURN_NONE;
+}
+
+/* node_labels(u, v, nodes, out, engine) -- component of the given nodes in out */
+static PyObject* sccs_node_labels(PyObject* self, PyObject* args) {
+	PyObject *ou, *ov, *on, *oo;
+	int engine = SCCS_ENGINE_UNION_FIND;
+	if(!PyArg_ParseTuple(args,"OOOO|i",&ou,&ov,&on,&oo,&engine)) return 0;
+	Py_buffer u, v, nodes, o;
+	if(!get_buffer(ou,&u,false,"u")) return 0;
+	if(!get_buffer(ov,&v,false,"v")) { PyBuffer_Release(&u); return 0; }
+	if(!get_buffer(on,&nodes,false,"nodes")) { PyBuffer_Release(&u); PyBuffer_Release(&v); return 0; }
+	if(!get_buffer(oo,&o,true,"out")) {
+		PyBuffer_Release(&u); PyBuffer_Release(&v); PyBuffer_Release(&nodes); return 0; }
+	int ret = -1;
+	if(v.len == u.len && o.len == nodes.len) {
+		Py_BEGIN_ALLOW_THREADS
+		ret = sccs_compute_nodes((const uint32_t*)u.buf,(const uint32_t*)v.buf,u.len / 4,
+			(const uint32_t*)nodes.buf,nodes.len / 4,(uint32_t*)o.buf,engine);
+		Py_END_ALLOW_THREADS
+	}
+	PyBuffer_Release(&u);
+	PyBuffer_Release(&v);
+	PyBuffer_Release(&nodes);
+	PyBuffer_Release(&o);
+	if(ret < 0) { PyErr_SetString(PyExc_ValueError,"u and v, nodes and out must have the same length"); return 0; }
+	if(ret) { PyErr_SetString(PyExc_RuntimeError,"error calculating components"); return 0; }
+	Py_RETURN_NONE;
+}
+
+/* components(u, v, engine) -- all nodes and their components, returned
+ * as two bytearray objects (so they can be used with numpy.frombuffer()
+ * without copying) */
+static PyObject* sccs_components(PyObject* self, PyObject* args) {
+	PyObject *ou, *ov;
+	int engine = SCCS_ENGINE_UNION_FIND;
+	if(!PyArg_ParseTuple(args,"OO|i",&ou,&ov,&engine)) return 0;
+	Py_buffer u, v;
+	if(!get_buffer(ou,&u,false,"u")) return 0;
+	if(!get_buffer(ov,&v,false,"v")) { PyBuffer_Release(&u); return 0; }
+	if(v.len != u.len) {
+		PyBuffer_Release(&u);
+		PyBuffer_Release(&v);
+		PyErr_SetString(PyExc_ValueError,"u and v must have the same length");
+		return 0;
+	}
+	sccs_result* r;
+	Py_BEGIN_ALLOW_THREADS
+	r = sccs_compute_result((const uint32_t*)u.buf,(const uint32_t*)v.buf,u.len / 4,engine);
+	Py_END_ALLOW_THREADS
+	PyBuffer_Release(&u);
+	PyBuffer_Release(&v);
+	if(!r) { PyErr_SetString(PyExc_RuntimeError,"error calculating components"); return 0; }
+	size_t n = sccs_result_nodes(r);
+	PyObject* nodes = PyByteArray_FromStringAndSize(0,n*4);
+	PyObject* labels = PyByteArray_FromStringAndSize(0,n*4);
+	if(!nodes || !labels) {
+		Py_XDECREF(nodes);
+		Py_XDECREF(labels);
+		sccs_result_free(r);
+		return 0;
+	}
+	uint32_t* pn = (uint32_t*)PyByteArray_AS_STRING(nodes);
+	uint32_t* pl = (uint32_t*)PyByteArray_AS_STRING(labels);
+	Py_BEGIN_ALLOW_THREADS
+	if(n) sccs_result_export(r,pn,pl);
+	sccs_result_free(r);
+	Py_END_ALLOW_THREADS
+	return Py_BuildValue("(NN)",nodes,labels);
+}
+
+static PyMethodDef sccs_methods[] = {
+	{"edge_labels",sccs_edge_labels,METH_VARARGS,"edge_labels(u, v, out, engine=0): store the component of each edge in out"},
+	{"node_labels",sccs_node_labels,METH_VARARGS,"node_labels(u, v, nodes, out, engine=0): store the component of the given nodes in out"},
+	{"components",sccs_components,METH_VARARGS,"components(u, v, engine=0): return all nodes and their components (as bytearrays)"},
+	{0,0,0,0}
+};
+
+static struct PyModuleDef sccs_module = {
+	PyModuleDef_HEAD_INIT,"_sccs","Connected components of graphs given as arrays of edges",-1,sccs_methods
+};
+
+PyMODINIT_FUNC PyInit__sccs(void) {
+	PyObject* m = PyModule_Create(&sccs_module);
+	if(!m) return 0;
+	PyModule_AddIntConstant(m,"ENGINE_UNION_FIND",SCCS_ENGINE_UNION_FIND);
+	PyModule_AddIntConstant(m,"ENGINE_ITERATIVE",SCCS_ENGINE_ITERATIVE);
+	return m;
+}
+
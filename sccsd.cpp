@@ -0,0 +1,542 @@
+/*
+ * sccsd.cpp -- daemon keeping connected components of a graph in memory,
+ * 	accepting new edges and answering queries about the components
+ * 	continuously over a Unix domain socket (see sccsd.h for the protocol)
+ *
+ * the components are stored in a union-find structure over the whole
+ * 32-bit ID space; this is a flat array that is only reserved in virtual
+ * memory (16 GiB), physical memory is only used for the parts where there
+ * are actual nodes (so it is best if node IDs are dense)
+ *
+ * edges received are added by a single thread in batches, while queries
+ * are answered by the threads serving the clients concurrently without
+ * any locking: the root of each component is always its smallest node ID
+ * and parent pointers always point to an ancestor, so a find operation
+ * always arrives at a valid root (that might be merged into a new component
+ * right after though)
+ *
+ * a snapshot of the components is written periodically (and at exit) in
+ * the same binary format as written by sccs32s with the -s option (node
+ * ID, component ID pairs), this is read back on start if it exists
+ *
+ * Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include <deque>
+#include <list>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* POSIX functions for memory management, sockets and signals */
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include "sccsd.h"
+
+
+/* union-find over all 32-bit IDs
+ * each entry stores the parent XOR the node ID, so zero initialized
+ * memory means that each node is its own root */
+struct atomic_uf {
+	protected:
+		std::atomic<uint32_t>* p;
+		std::atomic<uint64_t>* present; /* bitmap of nodes added */
+		static const size_t psize = (1UL << 32) * sizeof(uint32_t);
+		static const size_t bsize = (1UL << 32) / 8;
+		uint32_t parent(uint32_t x) const {
+			return p[x].load(std::memory_order_relaxed) ^ x;
+		}
+	public:
+		std::atomic<uint64_t> nnodes;
+		std::atomic<uint64_t> ncomps;
+
+		atomic_uf() : p(0),present(0),nnodes(0),ncomps(0) { }
+		~atomic_uf() {
+			if(p) munmap(p,psize);
+			if(present) munmap(present,bsize);
+		}
+		bool init() {
+			void* buf = mmap(0,psize,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,-1,0);
+			if(buf == MAP_FAILED) return false;
+			p = (std::atomic<uint32_t>*)buf;
+			buf = mmap(0,bsize,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,-1,0);
+			if(buf == MAP_FAILED) return false;
+			present = (std::atomic<uint64_t>*)buf;
+			return true;
+		}
+
+		bool contains(uint32_t x) const {
+			return present[x >> 6].load(std::memory_order_relaxed) & (1UL << (x & 63));
+		}
+
+		/* find the root of x, doing path halving; this can be called by
+		 * any thread: any ancestor of a node stays its ancestor, so
+		 * replacing its parent with its grandparent is always safe */
+		uint32_t find(uint32_t x) {
+			while(1) {
+				uint32_t y = parent(x);
+				if(y == x) return x;
+				uint32_t z = parent(y);
+				if(z != y) {
+					uint32_t tmp = y ^ x;
+					p[x].compare_exchange_weak(tmp,z ^ x,std::memory_order_relaxed);
+				}
+				x = z;
+			}
+		}
+
+		/* add an edge -- should be called only from one thread */
+		void unite(uint32_t a, uint32_t b) {
+			add(a);
+			add(b);
+			uint32_t r1 = find(a);
+			uint32_t r2 = find(b);
+			if(r1 == r2) return;
+			if(r2 < r1) std::swap(r1,r2);
+			p[r2].store(r1 ^ r2,std::memory_order_release);
+			ncomps--;
+		}
+		void add(uint32_t x) {
+			if(contains(x)) return;
+			present[x >> 6].fetch_or(1UL << (x & 63),std::memory_order_relaxed);
+			nnodes++;
+			ncomps++;
+		}
+
+		/* call f(x) for all nodes added */
+		template<class F> void for_each_node(F&& f) const {
+			for(size_t i=0;i<bsize/8;i++) {
+				uint64_t w = present[i].load(std::memory_order_relaxed);
+				while(w) {
+					unsigned int j = __builtin_ctzl(w);
+					f((uint32_t)((i << 6) + j));
+					w &= w - 1;
+				}
+			}
+		}
+};
+
+static atomic_uf uf;
+
+/* queue of edges waiting to be added */
+static std::mutex qm;
+static std::condition_variable qcv; /* signal new edges to the writer thread */
+static std::condition_variable qdone; /* signal processed edges to waiting clients */
+static std::deque<std::vector<uint32_t> > queue;
+static uint64_t qseq = 0; /* number of batches queued so far */
+static uint64_t qapplied = 0; /* number of batches processed so far */
+static bool snapshot_req = false; /* a client requested a snapshot */
+static uint64_t snapshot_seq = 0; /* number of snapshots written */
+static bool snapshot_ok = true; /* whether the last snapshot was successful */
+static bool stop = false; /* stop accepting new connections and edges */
+static bool writer_stop = false; /* all clients finished, write the last snapshot and exit */
+
+static const char* snapfn = 0;
+static unsigned int snap_interval = 600;
+
+/* write snapshot to a temporary file that is renamed when done */
+static bool write_snapshot() {
+	if(!snapfn) return false;
+	std::vector<char> tmpfn(strlen(snapfn) + 5);
+	sprintf(tmpfn.data(),"%s.tmp",snapfn);
+	FILE* f = fopen(tmpfn.data(),"w");
+	if(!f) {
+		fprintf(stderr,"Error opening snapshot file %s!\n",tmpfn.data());
+		return false;
+	}
+	uf.for_each_node([f](uint32_t x) {
+		uint32_t tmp[2] = {x,uf.find(x)};
+		fwrite(tmp,sizeof(uint32_t),2,f);
+	});
+	if(ferror(f) || fclose(f)) {
+		fprintf(stderr,"Error writing snapshot file %s!\n",tmpfn.data());
+		return false;
+	}
+	if(rename(tmpfn.data(),snapfn)) {
+		fprintf(stderr,"Error renaming snapshot file to %s!\n",snapfn);
+		return false;
+	}
+	time_t t1 = time(0);
+	fprintf(stderr,"%ssnapshot written, %lu nodes, %lu components\n",ctime(&t1),
+		uf.nnodes.load(),uf.ncomps.load());
+	return true;
+}
+
+/* read snapshot written previously */
+static bool read_snapshot() {
+	FILE* f = fopen(snapfn,"r");
+	if(!f) return true; /* no snapshot yet, start empty */
+	std::vector<uint32_t> buf(1UL << 20);
+	size_t r;
+	while((r = fread(buf.data(),2*sizeof(uint32_t),buf.size()/2,f)))
+		for(size_t i=0;i<r;i++) uf.unite(buf[2*i],buf[2*i+1]);
+	bool ret = !ferror(f);
+	fclose(f);
+	return ret;
+}
+
+/* thread adding edges and writing snapshots */
+static void writer_thread() {
+	std::vector<std::vector<uint32_t> > batches;
+	time_t last_snap = time(0);
+	bool changed = false;
+	std::unique_lock<std::mutex> lock(qm);
+	while(1) {
+		/* note: wake up periodically to check for snapshots */
+		if(queue.empty() && !writer_stop && !snapshot_req) qcv.wait_for(lock,std::chrono::seconds(1));
+		while(!queue.empty()) {
+			batches.push_back(std::move(queue.front()));
+			queue.pop_front();
+		}
+		bool do_snap = snapshot_req;
+		bool do_stop = writer_stop;
+		lock.unlock();
+
+		for(const auto& b : batches)
+			for(size_t i=0;i+1<b.size();i+=2) uf.unite(b[i],b[i+1]);
+		if(batches.size()) changed = true;
+		size_t nb = batches.size();
+		batches.clear();
+
+		time_t t1 = time(0);
+		bool snap_ret = true;
+		if(snapfn && (do_snap || do_stop || (changed && t1 - last_snap >= snap_interval))) {
+			snap_ret = write_snapshot();
+			last_snap = t1;
+			changed = false;
+		}
+
+		lock.lock();
+		qapplied += nb;
+		if(do_snap) {
+			snapshot_req = false;
+			snapshot_ok = snap_ret && snapfn;
+			snapshot_seq++;
+		}
+		qdone.notify_all();
+		if(do_stop && queue.empty()) break;
+	}
+}
+
+/* wait for the next request on fd; wakes up periodically to check if the
+ * server is stopping: in this case, returns false if there was no request
+ * for one period (so that the connection is closed) */
+static bool wait_request(int fd) {
+	struct pollfd p;
+	p.fd = fd;
+	p.events = POLLIN;
+	while(1) {
+		bool stopping;
+		{
+			std::lock_guard<std::mutex> lock(qm);
+			stopping = stop;
+		}
+		int r = poll(&p,1,1000);
+		if(r > 0) return true;
+		if(r < 0 && errno != EINTR) return false;
+		if(r == 0 && stopping) return false;
+	}
+}
+
+/* serve one client, until it disconnects (or until the server is
+ * stopping and there are no more requests from it); done is set when
+ * finished, so that the thread can be joined */
+static void client_thread(int fd, std::atomic<bool>* done) {
+	std::vector<uint32_t> buf;
+	std::vector<uint8_t> res;
+	while(1) {
+		sccsd_header h;
+		if(!wait_request(fd) || !sccsd_read(fd,&h,sizeof(h))) break;
+		sccsd_header r = {SCCSD_OK,0};
+		size_t len = 0; /* number of 32-bit values in the request */
+		if(h.n > sccsd_max_request) r.op = SCCSD_ETOOLARGE;
+		else switch(h.op) {
+			case SCCSD_UNION:
+			case SCCSD_CONNECTED:
+				len = 2*(size_t)h.n;
+				break;
+			case SCCSD_FIND:
+				len = h.n;
+				break;
+			case SCCSD_SYNC:
+			case SCCSD_SNAPSHOT:
+			case SCCSD_STATS:
+				break;
+			default:
+				r.op = SCCSD_EUNKNOWN;
+		}
+		if(r.op != SCCSD_OK) {
+			/* note: the rest of the request cannot be interpreted */
+			sccsd_write(fd,&r,sizeof(r));
+			break;
+		}
+		buf.resize(len);
+		if(len && !sccsd_read(fd,buf.data(),len*sizeof(uint32_t))) break;
+
+		bool ret = true;
+		switch(h.op) {
+			case SCCSD_UNION:
+				{
+					/* note: edges are not accepted after a signal, since
+					 * the last snapshot may already be written */
+					std::lock_guard<std::mutex> lock(qm);
+					if(stop) r.op = SCCSD_ESTOPPING;
+					else if(len) {
+						queue.push_back(std::move(buf));
+						qseq++;
+						qcv.notify_one();
+					}
+				}
+				buf = std::vector<uint32_t>();
+				ret = sccsd_write(fd,&r,sizeof(r));
+				break;
+			case SCCSD_FIND:
+				for(auto& x : buf) x = uf.find(x);
+				r.n = h.n;
+				ret = sccsd_write(fd,&r,sizeof(r)) && sccsd_write(fd,buf.data(),len*sizeof(uint32_t));
+				break;
+			case SCCSD_CONNECTED:
+				res.resize(h.n);
+				for(size_t i=0;i<h.n;i++) {
+					uint32_t x = buf[2*i];
+					uint32_t y = buf[2*i+1];
+					/* note: the roots can change in between, retry in this case */
+					while(1) {
+						uint32_t r1 = uf.find(x);
+						uint32_t r2 = uf.find(y);
+						if(r1 == r2) { res[i] = 1; break; }
+						if(uf.find(r1) == r1) { res[i] = 0; break; }
+					}
+				}
+				r.n = h.n;
+				ret = sccsd_write(fd,&r,sizeof(r)) && sccsd_write(fd,res.data(),h.n);
+				break;
+			case SCCSD_SYNC:
+				{
+					std::unique_lock<std::mutex> lock(qm);
+					uint64_t seq = qseq;
+					while(qapplied < seq) qdone.wait(lock);
+				}
+				ret = sccsd_write(fd,&r,sizeof(r));
+				break;
+			case SCCSD_SNAPSHOT:
+				{
+					std::unique_lock<std::mutex> lock(qm);
+					uint64_t seq = snapshot_seq;
+					snapshot_req = true;
+					qcv.notify_one();
+					while(snapshot_seq == seq) qdone.wait(lock);
+					if(!snapshot_ok) r.op = SCCSD_ESNAPSHOT;
+				}
+				ret = sccsd_write(fd,&r,sizeof(r));
+				break;
+			case SCCSD_STATS:
+				{
+					uint64_t tmp[2] = {uf.nnodes.load(),uf.ncomps.load()};
+					r.n = 2;
+					ret = sccsd_write(fd,&r,sizeof(r)) && sccsd_write(fd,tmp,sizeof(tmp));
+				}
+				break;
+		}
+		if(!ret) break;
+	}
+	close(fd);
+	*done = true;
+}
+
+/* thread serving a client, joined after it is done or on exit */
+struct client {
+	std::thread t;
+	std::atomic<bool> done;
+	client() : done(false) { }
+};
+
+
+int main(int argc, char **argv)
+{
+	char* sockfn = 0;
+
+	for(int i=1;i<argc;i++) if(argv[i][0] == '-') switch(argv[i][1]) {
+		case 's': /* socket to listen on, need to be given */
+			sockfn = argv[i+1];
+			break;
+		case 'f': /* file to use for snapshots */
+			snapfn = argv[i+1];
+			break;
+		case 'i': /* interval between snapshots (in seconds) */
+			snap_interval = strtoul(argv[i+1],0,10);
+			break;
+		default:
+			fprintf(stderr,"Unknown parameter: %s!\n",argv[i]);
+			break;
+	}
+
+	if(!sockfn) {
+		fprintf(stderr,"Error: no socket given!\n");
+		return 1;
+	}
+	struct sockaddr_un addr;
+	memset(&addr,0,sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(strlen(sockfn) >= sizeof(addr.sun_path)) {
+		fprintf(stderr,"Error: socket name too long!\n");
+		return 1;
+	}
+	strcpy(addr.sun_path,sockfn);
+
+	if(!uf.init()) {
+		fprintf(stderr,"Error allocating memory!\n");
+		return 11;
+	}
+	time_t t1 = time(0);
+	if(snapfn) {
+		fprintf(stderr,"%sreading snapshot\n",ctime(&t1));
+		if(!read_snapshot()) {
+			fprintf(stderr,"Error reading snapshot from %s!\n",snapfn);
+			return 1;
+		}
+		t1 = time(0);
+		fprintf(stderr,"%s%lu nodes, %lu components\n",ctime(&t1),uf.nnodes.load(),uf.ncomps.load());
+	}
+
+	int sfd = socket(AF_UNIX,SOCK_STREAM,0);
+	if(sfd == -1 || bind(sfd,(struct sockaddr*)&addr,sizeof(addr)) == -1 || listen(sfd,16) == -1) {
+		fprintf(stderr,"Error creating socket %s!\n",sockfn);
+		return 2;
+	}
+
+	/* handle signals in a separate thread: SIGINT and SIGTERM stop
+	 * accepting new connections and edges, then the program exits after
+	 * all clients finished their last requests, processing all edges
+	 * received and writing the snapshot */
+	sigset_t sigs;
+	sigemptyset(&sigs);
+	sigaddset(&sigs,SIGINT);
+	sigaddset(&sigs,SIGTERM);
+	pthread_sigmask(SIG_BLOCK,&sigs,0);
+	signal(SIGPIPE,SIG_IGN);
+	std::thread sigthread([sigs,sfd]() {
+		int sig;
+		sigwait(&sigs,&sig);
+		{
+			std::lock_guard<std::mutex> lock(qm);
+			stop = true;
+			qcv.notify_one();
+		}
+		shutdown(sfd,SHUT_RDWR);
+	});
+	std::thread writer(writer_thread);
+
+	t1 = time(0);
+	fprintf(stderr,"%slistening on %s\n",ctime(&t1),sockfn);
+	int ret = 0;
+	bool limit = false; /* accept() failed due to running out of resources */
+	std::list<client> clients;
+	auto join_clients = [&clients](bool all) {
+		for(auto it = clients.begin(); it != clients.end(); ) {
+			if(all || it->done) {
+				it->t.join();
+				it = clients.erase(it);
+			}
+			else ++it;
+		}
+	};
+	while(1) {
+		int fd = accept(sfd,0,0);
+		if(fd == -1) {
+			int err = errno;
+			if(err == EINTR || err == ECONNABORTED) continue;
+			/* too many connections (or no memory): this is temporary, wait
+			 * for some clients to disconnect */
+			if(err == EMFILE || err == ENFILE || err == ENOBUFS || err == ENOMEM) {
+				if(!limit) {
+					t1 = time(0);
+					fprintf(stderr,"%sError accepting connection: %s, retrying\n",ctime(&t1),strerror(err));
+					limit = true;
+				}
+				join_clients(false);
+				usleep(100000);
+				continue;
+			}
+			/* note: after a signal, accept() fails since sfd is shut down;
+			 * otherwise, this is a fatal error, stop the signal thread so
+			 * that the edges received are processed and the program exits */
+			bool stopping;
+			{
+				std::lock_guard<std::mutex> lock(qm);
+				stopping = stop;
+			}
+			if(!stopping) {
+				fprintf(stderr,"Error accepting connections: %s!\n",strerror(err));
+				pthread_kill(sigthread.native_handle(),SIGTERM);
+				ret = 3;
+			}
+			break;
+		}
+		limit = false;
+		join_clients(false);
+		clients.emplace_back();
+		clients.back().t = std::thread(client_thread,fd,&clients.back().done);
+	}
+
+	sigthread.join();
+	/* wait for the remaining clients: these close the connection after
+	 * their current requests, edges in them are still processed */
+	join_clients(true);
+	{
+		std::lock_guard<std::mutex> lock(qm);
+		writer_stop = true;
+		qcv.notify_one();
+	}
+	writer.join();
+	close(sfd);
+	unlink(sockfn);
+	t1 = time(0);
+	fprintf(stderr,"%sexiting, %lu nodes, %lu components\n",ctime(&t1),uf.nnodes.load(),uf.ncomps.load());
+	return ret;
+}
+
@@ -0,0 +1,108 @@
+/*
+ * sccsd.h -- protocol used between sccsd (daemon serving union and find
+ * 	queries) and its clients
+ *
+ * communication is done over a Unix domain stream socket; all numbers
+ * are in native byte order (client and server should be on the same
+ * machine anyway)
+ *
+ * each request starts with a header of two 32-bit unsigned integers (op
+ * code and the number of elements in the request, n), followed by the
+ * data for the request:
+ *   SCCSD_UNION: n pairs of node IDs (2*n 32-bit integers), edges to add
+ *   SCCSD_FIND: n node IDs, query their component
+ *   SCCSD_CONNECTED: n pairs of node IDs, query if they are connected
+ *   SCCSD_SYNC, SCCSD_SNAPSHOT, SCCSD_STATS: no data (n should be 0)
+ * each reply starts with the same header (status and number of elements),
+ * followed by the data for the reply:
+ *   SCCSD_UNION: no data (the edges are queued, but might not be processed
+ *     yet; use SCCSD_SYNC to wait for them)
+ *   SCCSD_FIND: n component IDs (32-bit integers), i.e. the smallest node
+ *     ID in the component; nodes not added yet are returned as themselves
+ *   SCCSD_CONNECTED: n bytes, 1 if the nodes are connected, 0 if not
+ *   SCCSD_SYNC: no data, the reply is sent after all edges queued before
+ *     were added
+ *   SCCSD_SNAPSHOT: no data, the reply is sent after a snapshot was written
+ *   SCCSD_STATS: two 64-bit integers: number of nodes and components
+ * status is 0 on success, or an error code (see below); on error, no data
+ * is sent in the reply
+ *
+ * Copyright 2018 Daniel Kondor <kondor.dani@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above
+ *   copyright notice, this list of conditions and the following disclaimer
+ *   in the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of the  nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _SCCSD_H
+#define _SCCSD_H
+
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+
+/* op codes */
+enum sccsd_ops { SCCSD_UNION = 1, SCCSD_FIND = 2, SCCSD_CONNECTED = 3,
+	SCCSD_SYNC = 4, SCCSD_SNAPSHOT = 5, SCCSD_STATS = 6 };
+/* status codes in the reply */
+enum sccsd_status { SCCSD_OK = 0, SCCSD_EUNKNOWN = 1, SCCSD_ETOOLARGE = 2,
+	SCCSD_ESNAPSHOT = 3, SCCSD_ESTOPPING = 4 };
+
+/* maximum number of elements in one request */
+static const uint32_t sccsd_max_request = 1U << 24;
+
+struct sccsd_header {
+	uint32_t op; /* op code in requests, status in replies */
+	uint32_t n;
+};
+
+/* helper functions to read / write the given amount of data, retrying
+ * after partial reads / writes; return false on error or end of file */
+static bool sccsd_read(int fd, void* buf, size_t len) {
+	char* p = (char*)buf;
+	while(len) {
+		ssize_t r = read(fd,p,len);
+		if(r < 0 && errno == EINTR) continue;
+		if(r <= 0) return false;
+		p += r;
+		len -= r;
+	}
+	return true;
+}
+static bool sccsd_write(int fd, const void* buf, size_t len) {
+	const char* p = (const char*)buf;
+	while(len) {
+		ssize_t r = write(fd,p,len);
+		if(r < 0 && errno == EINTR) continue;
+		if(r <= 0) return false;
+		p += r;
+		len -= r;
+	}
+	return true;
+}
+
+#endif /* _SCCSD_H */
+
@@ -0,0 +1,11 @@
+# build the Python extension, e.g. with
+#   python3 setup.py build_ext --inplace
+from setuptools import setup, Extension
+
+setup(
+    name="sccs",
+    version="0.1",
+    py_modules=["sccs"],
+    ext_modules=[Extension("_sccs", ["sccs_python.cpp", "sccs_capi.cpp"],
+                           extra_compile_args=["-std=gnu++14", "-O3"])],
+)